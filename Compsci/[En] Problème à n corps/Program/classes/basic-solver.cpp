@@ -0,0 +1,324 @@
+//
+//  basic-solver.cpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#include "basic-solver.hpp"
+#include "bodies.hpp"
+#include <cmath>
+#include <string>
+#include <vector>
+#include <array>
+#include <fstream>
+#include <iomanip>
+
+using namespace std;
+
+
+//  constructors
+
+template <int D, typename T>
+basic_solver<D, T>::basic_solver(void)
+{
+    static_assert(D == 2 || D == 3, "a solver has 2 or 3 dimensions");
+
+    _card = 0;
+    _time = 0.;
+}
+
+//  main algorithm
+
+template <int D, typename T>
+void basic_solver<D, T>::verlet(const T years, const std::string folder, const int steps)
+{
+    int timesteps;
+    T h;
+
+    timesteps = (int) (years * steps);
+    h = ((T) years) / ((T) timesteps);
+
+    //  like in solver, the bodies at the origin remain fixed
+    _fixed.resize(_card);
+
+    for(int k = 0; k < _card; k++)
+    {
+        T r_squared = 0.;
+
+        for(int d = 0; d < D; d++)
+        {
+            r_squared += _x[k][d] * _x[k][d];
+        }
+
+        _fixed[k] = (r_squared == 0.);
+    }
+
+    _open_output(folder, years);
+
+    _acceleration();
+    _a.swap(_next_a);
+
+    _write_positions();
+
+    for(int i = 0; i < timesteps; i++)
+    {
+        _step(h);
+        _write_positions();
+    }
+
+    _output.close();
+    _time += years;
+}
+
+//  getters
+
+template <int D, typename T>
+int basic_solver<D, T>::size(void) const
+{
+    return (_card);
+}
+
+////////
+
+template <int D, typename T>
+T basic_solver<D, T>::time(void) const
+{
+    return (_time);
+}
+
+////////
+
+template <int D, typename T>
+std::vector<basic_planet<D, T>> basic_solver<D, T>::system(void) const
+{
+    vector<basic_planet<D, T>> system;
+
+    for(int k = 0; k < _card; k++)
+    {
+        system.push_back(basic_planet<D, T>(_names[k], _m[k], _x[k], _v[k]));
+        system.back().time = _time;
+    }
+
+    return (system);
+}
+
+////////
+
+template <int D, typename T>
+T basic_solver<D, T>::total_energy(void) const
+{
+    T const g_const = 4 * M_PI * M_PI;
+    T energy = 0.;
+
+    for(int p = 0; p < _card; p++)
+    {
+        T v_squared = 0.;
+
+        for(int d = 0; d < D; d++)
+        {
+            v_squared += _v[p][d] * _v[p][d];
+        }
+
+        energy += 0.5 * _m[p] * v_squared;
+
+        for(int k = p + 1; k < _card; k++)
+        {
+            T r_squared = 0.;
+
+            for(int d = 0; d < D; d++)
+            {
+                r_squared += (_x[p][d] - _x[k][d]) * (_x[p][d] - _x[k][d]);
+            }
+
+            energy -= g_const * _m[p] * _m[k] / sqrt(r_squared);
+        }
+    }
+
+    return (energy);
+}
+
+////////
+
+template <int D, typename T>
+std::array<T, 3> basic_solver<D, T>::angular_momentum(void) const
+{
+    array<T, 3> momentum = {0., 0., 0.};
+
+    for(int k = 0; k < _card; k++)
+    {
+        array<T, 3> r = {_x[k][0], _x[k][1], 0.};
+        array<T, 3> v = {_v[k][0], _v[k][1], 0.};
+
+        //  never taken in 2D, where D - 1 only keeps the index in the array
+        if(D == 3)
+        {
+            r[2] = _x[k][D - 1];
+            v[2] = _v[k][D - 1];
+        }
+
+        momentum[0] += _m[k] * (r[1] * v[2] - r[2] * v[1]);
+        momentum[1] += _m[k] * (r[2] * v[0] - r[0] * v[2]);
+        momentum[2] += _m[k] * (r[0] * v[1] - r[1] * v[0]);
+    }
+
+    return (momentum);
+}
+
+//  methods
+
+template <int D, typename T>
+void basic_solver<D, T>::add(basic_planet<D, T> body)
+{
+    body.normalize();
+
+    _names.push_back(body.name());
+    _m.push_back(body.mass());
+    _x.push_back(body.position);
+    _v.push_back(body.velocity);
+    _card++;
+
+    _a.resize(_card);
+    _next_a.resize(_card);
+}
+
+////////
+
+//  the same operations as solver::_acceleration with the Newtonian force, in the same order
+template <int D, typename T>
+void basic_solver<D, T>::_acceleration(void)
+{
+    T const g_const = 4 * M_PI * M_PI;
+
+    for(int p = 0; p < _card; p++)
+    {
+        array<T, D>& a = _next_a[p];
+
+        a.fill(0.);
+
+        if(_fixed[p])
+        {
+            continue;
+        }
+
+        for(int k = 0; k < _card; k++)
+        {
+            array<T, D> relative;
+            T r_squared = 0.;
+
+            if(k == p)
+            {
+                continue;
+            }
+
+            for(int d = 0; d < D; d++)
+            {
+                relative[d] = _x[p][d] - _x[k][d];
+                r_squared += relative[d] * relative[d];
+            }
+
+            T r = sqrt(r_squared);
+            T radical = _m[k] / (r * r * r);
+
+            for(int d = 0; d < D; d++)
+            {
+                a[d] -= radical * relative[d];
+            }
+        }
+
+        for(int d = 0; d < D; d++)
+        {
+            a[d] *= g_const;
+        }
+    }
+}
+
+////////
+
+//  x(t+dt) = x(t) + dt*v(t) + (1/2)(dt^2)*a(t), then v(t+dt) = v(t) + (1/2)*dt*[a(t) + a(t+dt)]
+template <int D, typename T>
+void basic_solver<D, T>::_step(const T h)
+{
+    T radical = 0.5 * h * h;
+
+    for(int k = 0; k < _card; k++)
+    {
+        if(!_fixed[k])
+        {
+            for(int d = 0; d < D; d++)
+            {
+                _x[k][d] = _x[k][d] + h * _v[k][d] + radical * _a[k][d];
+            }
+        }
+    }
+
+    _acceleration();
+    radical = 0.5 * h;
+
+    for(int k = 0; k < _card; k++)
+    {
+        if(!_fixed[k])
+        {
+            for(int d = 0; d < D; d++)
+            {
+                _v[k][d] = _v[k][d] + radical * (_a[k][d] + _next_a[k][d]);
+            }
+        }
+    }
+
+    _a.swap(_next_a);
+}
+
+////////
+
+//  one text file per body, named by the body, with its D coordinates then its D velocities on each line
+template <int D, typename T>
+void basic_solver<D, T>::_open_output(const std::string folder, const T years)
+{
+    _output.open(folder, bodies());
+    _files.clear();
+
+    for(int k = 0; k < _card; k++)
+    {
+        ofstream& output = _output.file(_names[k]);
+
+        output << "Velocity-Verlet algorithm (" << D << "D)" << '\n';
+        output << _names[k] << ((D == 3) ? " (x, y, z, vx, vy, vz)" : " (x, y, vx, vy)") << '\n';
+        output << "Timestep: " << years << " years" << '\n' << '\n';
+
+        _files.push_back(&output);
+    }
+}
+
+////////
+
+template <int D, typename T>
+void basic_solver<D, T>::_write_positions(void)
+{
+    string space = "        ";
+
+    for(int k = 0; k < _card; k++)
+    {
+        ofstream& output = *_files[k];
+
+        for(int d = 0; d < D; d++)
+        {
+            output << setprecision(12) << _x[k][d] << space;
+        }
+        for(int d = 0; d < D; d++)
+        {
+            output << setprecision(12) << _v[k][d] << space;
+        }
+        output << '\n';
+    }
+}
+
+
+template class basic_solver<2, float>;
+template class basic_solver<2, double>;
+template class basic_solver<2, long double>;
+template class basic_solver<3, float>;
+template class basic_solver<3, double>;
+template class basic_solver<3, long double>;
@@ -0,0 +1,85 @@
+//
+//  basic-solver.hpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#pragma once
+#include <vector>
+#include <array>
+#include <string>
+#include <fstream>
+#include "planet.hpp"
+#include "trajectory.hpp"
+
+
+//  velocity Verlet with the direct sum, for the planets in D dimensions (2 or 3) with the scalar type T (see basic_planet)
+//  solver has all the algorithms and the options, in 2D with doubles; this is the 3D mode and the float or long double one
+//  the steps are the ones of solver::verlet with its default options, in the same order:
+//  basic_solver<2, double> gives exactly its positions, and a 3D system in the plane z = 0 gives them too
+//  the position, the velocity and the acceleration of a body are std::array<T, D>, so the loops over the coordinates are unrolled
+
+template <int D, typename T = double>
+class basic_solver
+{
+
+public:
+
+    //  constructors
+
+    basic_solver(void);
+
+    //  main algorithm
+
+    void verlet(const T years, const std::string folder, const int steps = 365);  //  steps per year
+
+    //  getters
+
+    int size(void) const;
+    T time(void) const;
+    std::vector<basic_planet<D, T>> system(void) const; //  normalized like in solver::system
+    T total_energy(void) const; //  each pair counted once, like ensemble::energy
+    std::array<T, 3> angular_momentum(void) const;  //  about the origin, only its z component in 2D
+
+    //  methods
+
+    void add(basic_planet<D, T> body);  //  normalized like in solver::add, the bodies at the origin remain fixed
+
+
+private:
+
+    //  data
+
+    int _card;
+    T _time;
+    std::vector<std::string> _names;
+    std::vector<T> _m;
+    std::vector<std::array<T, D>> _x;
+    std::vector<std::array<T, D>> _v;
+    std::vector<std::array<T, D>> _a;
+    std::vector<std::array<T, D>> _next_a;
+    std::vector<bool> _fixed;
+    trajectory _output;
+    std::vector<std::ofstream*> _files;
+
+    //  methods
+
+    void _acceleration(void);   //  fills _next_a
+    void _step(const T h);
+    void _open_output(const std::string folder, const T years);
+    void _write_positions(void);
+};
+
+
+//  compiled in basic-solver.cpp for the same dimensions and types as basic_planet
+typedef basic_solver<3, double> solver3d;
+
+extern template class basic_solver<2, float>;
+extern template class basic_solver<2, double>;
+extern template class basic_solver<2, long double>;
+extern template class basic_solver<3, float>;
+extern template class basic_solver<3, double>;
+extern template class basic_solver<3, long double>;
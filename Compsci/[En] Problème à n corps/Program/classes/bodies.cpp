@@ -0,0 +1,110 @@
+//
+//  bodies.cpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#include "bodies.hpp"
+#include "planet.hpp"
+#include <iomanip>
+#include <vector>
+#include <string>
+
+using namespace std;
+
+//  constructors
+
+bodies::bodies(void)
+{
+    time = 0.;
+}
+
+//  getters
+
+int bodies::size(void) const
+{
+    return ((int) m.size());
+}
+
+////////
+
+planet bodies::body(const int k) const
+{
+    planet body(name[k], m[k], x[k], y[k], vx[k], vy[k]);
+
+    body.time = time;
+
+    return (body);
+}
+
+//  methods
+
+void bodies::push_back(const planet& body)
+{
+    name.push_back(body.name());
+    m.push_back(body.mass());
+    x.push_back(body.position[0]);
+    y.push_back(body.position[1]);
+    vx.push_back(body.velocity[0]);
+    vy.push_back(body.velocity[1]);
+
+    prev_x.push_back(body.position[0]);
+    prev_y.push_back(body.position[1]);
+    prev_vx.push_back(body.velocity[0]);
+    prev_vy.push_back(body.velocity[1]);
+    prev_ax.push_back(0.);
+    prev_ay.push_back(0.);
+    next_ax.push_back(0.);
+    next_ay.push_back(0.);
+}
+
+////////
+
+void bodies::save(void)
+{
+    int n = size();
+
+    for(int k = 0; k < n; k++)
+    {
+        prev_x[k] = x[k];
+        prev_y[k] = y[k];
+        prev_vx[k] = vx[k];
+        prev_vy[k] = vy[k];
+    }
+}
+
+////////
+
+//  the vectors keep their memory, so copying the same system again allocates nothing
+void bodies::copy_state(const bodies& other)
+{
+    time = other.time;
+    m.assign(other.m.begin(), other.m.end());
+    x.assign(other.x.begin(), other.x.end());
+    y.assign(other.y.begin(), other.y.end());
+    vx.assign(other.vx.begin(), other.vx.end());
+    vy.assign(other.vy.begin(), other.vy.end());
+}
+
+////////
+
+void bodies::print_pos(const int k, std::ofstream& output) const
+{
+    string space = "        ";
+
+    output << setprecision(12) << x[k] << space;
+    output << setprecision(12) << y[k] << space;
+}
+
+////////
+
+void bodies::print_vel(const int k, std::ofstream& output) const
+{
+    string space = "        ";
+
+    output << setprecision(12) << vx[k] << space;
+    output << setprecision(12) << vy[k] << space;
+}
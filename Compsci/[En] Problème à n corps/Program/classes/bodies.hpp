@@ -0,0 +1,69 @@
+//
+//  bodies.hpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include "planet.hpp"
+
+
+//  contiguous storage of the celestial bodies of a solver (structure of arrays)
+//  the body k is (x[k], y[k], vx[k], vy[k], m[k])
+//  this is what the algorithms work on, planet is only used to add a body or to export it
+
+class bodies
+{
+
+public:
+
+    //  constructors
+
+    bodies(void);
+
+    //  data
+
+    double time;    //  time of the last step, same as planet::time
+    std::vector<std::string> name;
+    std::vector<double> m;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> vx;
+    std::vector<double> vy;
+
+    //  quantities at ti, and the acceleration at ti+1 for Verlet
+    std::vector<double> prev_x;
+    std::vector<double> prev_y;
+    std::vector<double> prev_vx;
+    std::vector<double> prev_vy;
+    std::vector<double> prev_ax;
+    std::vector<double> prev_ay;
+    std::vector<double> next_ax;
+    std::vector<double> next_ay;
+
+    //  getters
+
+    int size(void) const;
+    planet body(const int k) const;  //  exports the body k as a planet
+
+    //  methods
+
+    void push_back(const planet& body); //  the planet must already be normalized
+    bool center(const int k) const;  //  true if the body k is at the origin, see solver::_acceleration
+    void save(void);    //  copies the current positions and velocities in the prev_ vectors
+    void copy_state(const bodies& other);   //  copies the time, masses, positions and velocities of other, not the rest
+    void print_pos(const int k, std::ofstream& output) const;   //  same columns as planet::print_pos
+    void print_vel(const int k, std::ofstream& output) const;   //  idem
+};
+
+
+inline bool bodies::center(const int k) const
+{
+    return (x[k] * x[k] + y[k] * y[k] == 0.);
+}
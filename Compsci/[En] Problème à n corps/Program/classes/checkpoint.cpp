@@ -0,0 +1,127 @@
+//
+//  checkpoint.cpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#include "checkpoint.hpp"
+#include "bodies.hpp"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+
+//  the arrays of a checkpoint, in the order of the file
+static vector<double> bodies::* const arrays[] = {&bodies::m, &bodies::x, &bodies::y, &bodies::vx, &bodies::vy,
+    &bodies::prev_x, &bodies::prev_y, &bodies::prev_vx, &bodies::prev_vy, &bodies::prev_ax, &bodies::prev_ay, &bodies::next_ax, &bodies::next_ay};
+
+static const uint32_t checkpoint_version = 1;
+
+
+static void write_bodies(ofstream& file, const bodies& system)
+{
+    int n = system.size();
+
+    for(int k = 0; k < n; k++)
+    {
+        uint32_t length = (uint32_t) system.name[k].size();
+
+        file.write((const char*) &length, sizeof(length));
+        file.write(system.name[k].data(), length);
+    }
+
+    for(auto array : arrays)
+    {
+        file.write((const char*) (system.*array).data(), n * sizeof(double));
+    }
+}
+
+////////
+
+static bool read_bodies(ifstream& file, const int n, bodies& system)
+{
+    system.name.resize(n);
+
+    for(int k = 0; k < n; k++)
+    {
+        uint32_t length = 0;
+
+        file.read((char*) &length, sizeof(length));
+        if(!file)
+        {
+            return (false);
+        }
+
+        system.name[k].resize(length);
+        file.read(&system.name[k][0], length);
+    }
+
+    for(auto array : arrays)
+    {
+        (system.*array).resize(n);
+        file.read((char*) (system.*array).data(), n * sizeof(double));
+    }
+
+    return ((bool) file);
+}
+
+////////
+
+void write_checkpoint(const std::string path, checkpoint_header header, const bodies& system, const bodies& particles)
+{
+    string temporary = path + ".tmp";
+    ofstream file(temporary, ios::out | ios::binary);
+
+    memcpy(header.magic, "NBODYCKP", 8);
+    header.version = checkpoint_version;
+    header.bodies = system.size();
+    header.particles = particles.size();
+    header.reserved = 0;
+    header.bodies_time = system.time;
+    header.particles_time = particles.time;
+
+    file.write((const char*) &header, sizeof(header));
+    write_bodies(file, system);
+    write_bodies(file, particles);
+    file.close();
+
+    //  the previous checkpoint is kept, but the run can't go on without saving its state
+    if(!file || rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        cout << "The checkpoint " << path << " can't be written." << endl;
+        exit(1);
+    }
+}
+
+////////
+
+bool read_checkpoint(const std::string path, checkpoint_header& header, bodies& system, bodies& particles)
+{
+    ifstream file(path, ios::in | ios::binary);
+
+    file.read((char*) &header, sizeof(header));
+
+    if(!file || memcmp(header.magic, "NBODYCKP", 8) != 0 || header.version != checkpoint_version)
+    {
+        return (false);
+    }
+
+    if(!read_bodies(file, header.bodies, system) || !read_bodies(file, header.particles, particles))
+    {
+        return (false);
+    }
+
+    system.time = header.bodies_time;
+    particles.time = header.particles_time;
+
+    return (true);
+}
@@ -0,0 +1,41 @@
+//
+//  checkpoint.hpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#pragma once
+#include <string>
+#include <cstdint>
+#include "bodies.hpp"
+
+
+//  binary checkpoint of a solver (see solver::checkpoint), in the byte order of the machine
+//
+//  header              sizeof(checkpoint_header) bytes
+//  planets             for each body the length of its name (uint32) then its name
+//                      then 13 arrays of bodies doubles: m, x, y, vx, vy, prev_x, prev_y, prev_vx, prev_vy, prev_ax, prev_ay, next_ax, next_ay
+//  test particles      idem with particles values
+//
+//  the doubles are copied as they are in memory, so a solver read back goes on exactly like the one that was written
+//  the file is written under the name path + ".tmp", then renamed: a crash while writing keeps the previous checkpoint
+
+struct checkpoint_header
+{
+    char magic[8];  //  "NBODYCKP"
+    std::uint32_t version;
+    std::uint32_t bodies;
+    std::uint32_t particles;
+    std::uint32_t reserved;
+    double time;    //  solver::time
+    double total_mass;
+    double mass_center[2];
+    double bodies_time; //  bodies::time of the planets and of the test particles
+    double particles_time;
+};
+
+void write_checkpoint(const std::string path, checkpoint_header header, const bodies& system, const bodies& particles);    //  exits if the file can't be written
+bool read_checkpoint(const std::string path, checkpoint_header& header, bodies& system, bodies& particles);  //  false if the file can't be read
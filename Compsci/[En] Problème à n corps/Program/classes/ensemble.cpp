@@ -0,0 +1,593 @@
+//
+//  ensemble.cpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#include "ensemble.hpp"
+#include "planet.hpp"
+#include "bodies.hpp"
+#include "trajectory.hpp"
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+//  same conditions as in kernels.cpp
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define ENSEMBLE_X86
+#include <immintrin.h>
+#endif
+#include "parallel.hpp"
+
+using namespace std;
+
+
+//  the attraction of the body k on the body p in every member, same arithmetic as solver::_acceleration
+static void attraction(const int members, const double m_k, const double* x_p, const double* y_p, const double* x_k, const double* y_k, double* ax_p, double* ay_p)
+{
+    for(int e = 0; e < members; e++)
+    {
+        double relative_x = x_p[e] - x_k[e];
+        double relative_y = y_p[e] - y_k[e];
+        double r = sqrt(relative_x * relative_x + relative_y * relative_y);
+        double r_squared = r * r;
+        double radical = m_k / (r_squared * r);
+
+        ax_p[e] -= radical * relative_x;
+        ay_p[e] -= radical * relative_y;
+    }
+}
+
+////////
+
+//  r^power for r > 0, as exp(power log(r)) with polynomials instead of pow, so that power_avx2 can do the same
+//  operations on 4 values: a member gets the same results with or without AVX2, and with any other members
+//  log: r = m 2^e with m in [sqrt(1/2), sqrt(2)), log(m) = 2 s (1 + s^2/3 + s^4/5 + ...) with s = (m - 1) / (m + 1), |s| < 0.172
+//  exp: y = n log(2) + f with |f| <= log(2) / 2, exp(f) by its Taylor series, then times 2^n
+//  the relative error stays below 1.E-14 from 1.E-3 to 1.E3 AU, and is much smaller than the one of the steps
+
+static const double ln2_high = 6.93147180369123816490E-01;  //  log(2) = ln2_high + ln2_low, and n * ln2_high is exact
+static const double ln2_low = 1.90821492927058770002E-10;
+static const double inverse_ln2 = 1.44269504088896338700E+00;
+static const double log_series[10] = {1. / 3., 1. / 5., 1. / 7., 1. / 9., 1. / 11., 1. / 13., 1. / 15., 1. / 17., 1. / 19., 1. / 21.};
+static const double exp_series[14] = {1., 1., 1. / 2., 1. / 6., 1. / 24., 1. / 120., 1. / 720., 1. / 5040., 1. / 40320., 1. / 362880.,
+    1. / 3628800., 1. / 39916800., 1. / 479001600., 1. / 6227020800.};
+
+static inline double power(const double r, const double exponent)
+{
+    int e;
+    double m = frexp(r, &e);    //  in [1/2, 1)
+    double s, z, series, log_r, y, n, f, result;
+
+    if(m < M_SQRT1_2)
+    {
+        m = 2. * m;
+        e--;
+    }
+
+    s = (m - 1.) / (m + 1.);
+    z = s * s;
+    series = log_series[9];
+
+    for(int i = 8; i >= 0; i--)
+    {
+        series = series * z + log_series[i];
+    }
+
+    series = series * z + 1.;
+    log_r = (e * ln2_high + 2. * s * series) + e * ln2_low;
+
+    y = exponent * log_r;
+    n = nearbyint(y * inverse_ln2);
+    f = (y - n * ln2_high) - n * ln2_low;
+    result = exp_series[13];
+
+    for(int i = 12; i >= 0; i--)
+    {
+        result = result * f + exp_series[i];
+    }
+
+    return (ldexp(result, (int) n));
+}
+
+////////
+
+//  the attraction of the body k on the body p with the exponent of each member, -m r / |r|^power
+//  the members with the Newtonian force keep the arithmetic of attraction
+static void attraction_power(const int members, const double m_k, const double* power_e, const double* x_p, const double* y_p, const double* x_k, const double* y_k, double* ax_p, double* ay_p)
+{
+    for(int e = 0; e < members; e++)
+    {
+        double relative_x = x_p[e] - x_k[e];
+        double relative_y = y_p[e] - y_k[e];
+        double r = sqrt(relative_x * relative_x + relative_y * relative_y);
+        double radical = (power_e[e] == 3.) ? m_k / ((r * r) * r) : m_k / power(r, power_e[e]);
+
+        ax_p[e] -= radical * relative_x;
+        ay_p[e] -= radical * relative_y;
+    }
+}
+
+////////
+
+#ifdef ENSEMBLE_X86
+
+//  4 members at once, the square root and the division are exact: the results are the ones of attraction
+__attribute__((target("avx2")))
+static void attraction_avx2(const int members, const double m_k, const double* x_p, const double* y_p, const double* x_k, const double* y_k, double* ax_p, double* ay_p)
+{
+    __m256d mass = _mm256_set1_pd(m_k);
+    int e = 0;
+
+    for(; e + 4 <= members; e += 4)
+    {
+        __m256d relative_x = _mm256_sub_pd(_mm256_loadu_pd(x_p + e), _mm256_loadu_pd(x_k + e));
+        __m256d relative_y = _mm256_sub_pd(_mm256_loadu_pd(y_p + e), _mm256_loadu_pd(y_k + e));
+        __m256d r = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(relative_x, relative_x), _mm256_mul_pd(relative_y, relative_y)));
+        __m256d r_squared = _mm256_mul_pd(r, r);
+        __m256d radical = _mm256_div_pd(mass, _mm256_mul_pd(r_squared, r));
+
+        _mm256_storeu_pd(ax_p + e, _mm256_sub_pd(_mm256_loadu_pd(ax_p + e), _mm256_mul_pd(radical, relative_x)));
+        _mm256_storeu_pd(ay_p + e, _mm256_sub_pd(_mm256_loadu_pd(ay_p + e), _mm256_mul_pd(radical, relative_y)));
+    }
+
+    attraction(members - e, m_k, x_p + e, y_p + e, x_k + e, y_k + e, ax_p + e, ay_p + e);
+}
+
+////////
+
+//  the operations of power on 4 values, r = m 2^e is read from the bits of r
+__attribute__((target("avx2")))
+static __m256d power_avx2(const __m256d r, const __m256d exponent)
+{
+    const __m256i mantissa_bits = _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL);
+    const __m256i half_exponent = _mm256_set1_epi64x(0x3FE0000000000000LL);   //  the exponent of [1/2, 1)
+    const __m256d two_52 = _mm256_set1_pd(4503599627370496.);  //  2^52, whose last bits are an integer added to it
+    const __m256d one = _mm256_set1_pd(1.);
+    const __m256d two = _mm256_set1_pd(2.);
+    __m256i bits = _mm256_castpd_si256(r);
+    __m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, mantissa_bits), half_exponent));
+    __m256d biased = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_castpd_si256(two_52))), two_52);
+    __m256d e = _mm256_sub_pd(biased, _mm256_set1_pd(1022.));
+    __m256d small = _mm256_cmp_pd(m, _mm256_set1_pd(M_SQRT1_2), _CMP_LT_OQ);
+
+    m = _mm256_blendv_pd(m, _mm256_mul_pd(two, m), small);
+    e = _mm256_blendv_pd(e, _mm256_sub_pd(e, one), small);
+
+    __m256d s = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+    __m256d z = _mm256_mul_pd(s, s);
+    __m256d series = _mm256_set1_pd(log_series[9]);
+
+    for(int i = 8; i >= 0; i--)
+    {
+        series = _mm256_add_pd(_mm256_mul_pd(series, z), _mm256_set1_pd(log_series[i]));
+    }
+
+    series = _mm256_add_pd(_mm256_mul_pd(series, z), one);
+
+    __m256d log_r = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(e, _mm256_set1_pd(ln2_high)), _mm256_mul_pd(_mm256_mul_pd(two, s), series)), _mm256_mul_pd(e, _mm256_set1_pd(ln2_low)));
+    __m256d y = _mm256_mul_pd(exponent, log_r);
+    __m256d n = _mm256_round_pd(_mm256_mul_pd(y, _mm256_set1_pd(inverse_ln2)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d f = _mm256_sub_pd(_mm256_sub_pd(y, _mm256_mul_pd(n, _mm256_set1_pd(ln2_high))), _mm256_mul_pd(n, _mm256_set1_pd(ln2_low)));
+    __m256d result = _mm256_set1_pd(exp_series[13]);
+
+    for(int i = 12; i >= 0; i--)
+    {
+        result = _mm256_add_pd(_mm256_mul_pd(result, f), _mm256_set1_pd(exp_series[i]));
+    }
+
+    //  2^n from the bits of n + 1023
+    __m256i scale = _mm256_slli_epi64(_mm256_castpd_si256(_mm256_add_pd(_mm256_add_pd(n, _mm256_set1_pd(1023.)), two_52)), 52);
+
+    return (_mm256_mul_pd(result, _mm256_castsi256_pd(scale)));
+}
+
+////////
+
+//  4 members at once with their own exponents, the results are the ones of attraction_power
+__attribute__((target("avx2")))
+static void attraction_power_avx2(const int members, const double m_k, const double* power_e, const double* x_p, const double* y_p, const double* x_k, const double* y_k, double* ax_p, double* ay_p)
+{
+    __m256d mass = _mm256_set1_pd(m_k);
+    __m256d newtonian = _mm256_set1_pd(3.);
+    int e = 0;
+
+    for(; e + 4 <= members; e += 4)
+    {
+        __m256d exponent = _mm256_loadu_pd(power_e + e);
+        __m256d relative_x = _mm256_sub_pd(_mm256_loadu_pd(x_p + e), _mm256_loadu_pd(x_k + e));
+        __m256d relative_y = _mm256_sub_pd(_mm256_loadu_pd(y_p + e), _mm256_loadu_pd(y_k + e));
+        __m256d r = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(relative_x, relative_x), _mm256_mul_pd(relative_y, relative_y)));
+        __m256d cubed = _mm256_div_pd(mass, _mm256_mul_pd(_mm256_mul_pd(r, r), r));
+        __m256d other = _mm256_div_pd(mass, power_avx2(r, exponent));
+        __m256d radical = _mm256_blendv_pd(other, cubed, _mm256_cmp_pd(exponent, newtonian, _CMP_EQ_OQ));
+
+        _mm256_storeu_pd(ax_p + e, _mm256_sub_pd(_mm256_loadu_pd(ax_p + e), _mm256_mul_pd(radical, relative_x)));
+        _mm256_storeu_pd(ay_p + e, _mm256_sub_pd(_mm256_loadu_pd(ay_p + e), _mm256_mul_pd(radical, relative_y)));
+    }
+
+    attraction_power(members - e, m_k, power_e + e, x_p + e, y_p + e, x_k + e, y_k + e, ax_p + e, ay_p + e);
+}
+
+#endif
+
+
+//  constructors
+
+ensemble::ensemble(const int members)
+{
+    _members = (members > 0) ? members : 1;
+    _level = kernel_best();
+    _card = 0;
+    _time = 0.;
+    _power.assign(_members, 3.);
+    _start_energy.assign(_members, 0.);
+    _energy_error.assign(_members, 0.);
+}
+
+//  main algorithm
+
+//  the same steps as solver::verlet for every member: with the Newtonian force
+//  a member gives the results of a solver with the same bodies, up to the rounding errors
+void ensemble::verlet(const double years, const std::string folder, const int steps)
+{
+    int timesteps;
+    double h;
+    int n = _card * _members;
+
+    timesteps = (int) (years * steps);
+    h = ((double) years) / ((double) timesteps);
+
+    //  like in solver, the bodies at the origin remain fixed
+    _mobile.resize(n);
+    _min_distance.resize(n);
+    _max_distance.resize(n);
+
+    for(int i = 0; i < n; i++)
+    {
+        _mobile[i] = (_x[i] * _x[i] + _y[i] * _y[i] == 0.) ? 0. : 1.;
+        _min_distance[i] = sqrt(_x[i] * _x[i] + _y[i] * _y[i]);
+        _max_distance[i] = _min_distance[i];
+    }
+
+    for(int e = 0; e < _members; e++)
+    {
+        _start_energy[e] = energy(e);
+    }
+
+    _open_output(folder, years);
+
+    _acceleration();
+    _ax.swap(_next_ax);
+    _ay.swap(_next_ay);
+
+    _write_positions();
+
+    for(int i = 0; i < timesteps; i++)
+    {
+        _step(h);
+        _update_distances();
+        _write_positions();
+    }
+
+    _output.close();
+    _time += years;
+
+    for(int e = 0; e < _members; e++)
+    {
+        //  an energy of 0 (a parabolic orbit) gives the absolute change
+        _energy_error[e] = energy(e) - _start_energy[e];
+        _energy_error[e] /= (_start_energy[e] != 0.) ? fabs(_start_energy[e]) : 1.;
+    }
+
+    _write_diagnostics(folder);
+}
+
+//  getters
+
+int ensemble::members(void) const
+{
+    return (_members);
+}
+
+////////
+
+int ensemble::size(void) const
+{
+    return (_card);
+}
+
+////////
+
+double ensemble::time(void) const
+{
+    return (_time);
+}
+
+////////
+
+planet ensemble::body(const int e, const int k) const
+{
+    int i = k * _members + e;
+    planet body(_names[k], _m[k], _x[i], _y[i], _vx[i], _vy[i]);
+
+    body.time = _time;
+
+    return (body);
+}
+
+////////
+
+//  the potential of the force G m1 m2 / r^(power - 1) is - G m1 m2 / ((power - 2) r^(power - 2)), and G m1 m2 log(r) for power = 2
+double ensemble::energy(const int e) const
+{
+    double const g_const = 4 * M_PI * M_PI;
+    double power = _power[e];
+    double energy = 0.;
+
+    for(int p = 0; p < _card; p++)
+    {
+        int i = p * _members + e;
+
+        energy += 0.5 * _m[p] * (_vx[i] * _vx[i] + _vy[i] * _vy[i]);
+
+        for(int k = p + 1; k < _card; k++)
+        {
+            int j = k * _members + e;
+            double r = sqrt((_x[i] - _x[j]) * (_x[i] - _x[j]) + (_y[i] - _y[j]) * (_y[i] - _y[j]));
+
+            if(power == 2.)
+            {
+                energy += g_const * _m[p] * _m[k] * log(r);
+            }
+            else
+            {
+                energy -= g_const * _m[p] * _m[k] / ((power - 2.) * pow(r, power - 2.));
+            }
+        }
+    }
+
+    return (energy);
+}
+
+////////
+
+double ensemble::energy_error(const int e) const
+{
+    return (_energy_error[e]);
+}
+
+////////
+
+double ensemble::min_distance(const int e, const int k) const
+{
+    return (_min_distance[k * _members + e]);
+}
+
+////////
+
+double ensemble::max_distance(const int e, const int k) const
+{
+    return (_max_distance[k * _members + e]);
+}
+
+//  methods
+
+void ensemble::add(planet body)
+{
+    body.normalize();
+
+    _names.push_back(body.name());
+    _m.push_back(body.mass());
+    _x.insert(_x.end(), _members, body.position[0]);
+    _y.insert(_y.end(), _members, body.position[1]);
+    _vx.insert(_vx.end(), _members, body.velocity[0]);
+    _vy.insert(_vy.end(), _members, body.velocity[1]);
+    _card++;
+
+    _ax.resize(_card * _members);
+    _ay.resize(_card * _members);
+    _next_ax.resize(_card * _members);
+    _next_ay.resize(_card * _members);
+}
+
+////////
+
+void ensemble::velocity(const int e, const int k, const double vx, const double vy)
+{
+    //  same normalization as planet::normalize
+    _vx[k * _members + e] = vx * 365.25;
+    _vy[k * _members + e] = vy * 365.25;
+}
+
+////////
+
+void ensemble::exponent(const int e, const double power)
+{
+    _power[e] = power;
+}
+
+////////
+
+//  the same operations as solver::_acceleration for each member, in the same order
+//  the loop over the members is vectorized, see attraction_avx2, and attraction_power_avx2 for the other exponents
+void ensemble::_acceleration(void)
+{
+    double const g_const = 4 * M_PI * M_PI;
+    int n = _card * _members;
+    int members = _members;
+    const double* power = _power.data();
+    bool newtonian = all_of(_power.begin(), _power.end(), [](const double value) {return (value == 3.);});
+
+    fill(_next_ax.begin(), _next_ax.end(), 0.);
+    fill(_next_ay.begin(), _next_ay.end(), 0.);
+
+    for(int p = 0; p < _card; p++)
+    {
+        const double* x_p = _x.data() + p * members;
+        const double* y_p = _y.data() + p * members;
+        double* ax_p = _next_ax.data() + p * members;
+        double* ay_p = _next_ay.data() + p * members;
+
+        for(int k = 0; k < _card; k++)
+        {
+            const double* x_k = _x.data() + k * members;
+            const double* y_k = _y.data() + k * members;
+            double m_k = _m[k];
+
+            if(k == p)
+            {
+                continue;
+            }
+
+#ifdef ENSEMBLE_X86
+            if(newtonian && _level != kernel_scalar)
+            {
+                attraction_avx2(members, m_k, x_p, y_p, x_k, y_k, ax_p, ay_p);
+            }
+            else if(_level != kernel_scalar)
+            {
+                attraction_power_avx2(members, m_k, power, x_p, y_p, x_k, y_k, ax_p, ay_p);
+            }
+            else
+#endif
+            if(newtonian)
+            {
+                attraction(members, m_k, x_p, y_p, x_k, y_k, ax_p, ay_p);
+            }
+            else
+            {
+                attraction_power(members, m_k, power, x_p, y_p, x_k, y_k, ax_p, ay_p);
+            }
+        }
+    }
+
+    OMP(simd)
+    for(int i = 0; i < n; i++)
+    {
+        _next_ax[i] = (_mobile[i] != 0.) ? _next_ax[i] * g_const : 0.;
+        _next_ay[i] = (_mobile[i] != 0.) ? _next_ay[i] * g_const : 0.;
+    }
+}
+
+////////
+
+//  x(t+dt) = x(t) + dt*v(t) + (1/2)(dt^2)*a(t)
+//  v(t+dt) = v(t) + (1/2)*dt*[a(t) + a(t+dt)]
+void ensemble::_step(const double h)
+{
+    int n = _card * _members;
+    double radical = 0.5 * h * h;
+
+    OMP(simd)
+    for(int i = 0; i < n; i++)
+    {
+        _x[i] = (_mobile[i] != 0.) ? _x[i] + h * _vx[i] + radical * _ax[i] : _x[i];
+        _y[i] = (_mobile[i] != 0.) ? _y[i] + h * _vy[i] + radical * _ay[i] : _y[i];
+    }
+
+    _acceleration();
+    radical = 0.5 * h;
+
+    OMP(simd)
+    for(int i = 0; i < n; i++)
+    {
+        _vx[i] = (_mobile[i] != 0.) ? _vx[i] + radical * (_ax[i] + _next_ax[i]) : _vx[i];
+        _vy[i] = (_mobile[i] != 0.) ? _vy[i] + radical * (_ay[i] + _next_ay[i]) : _vy[i];
+    }
+
+    _ax.swap(_next_ax);
+    _ay.swap(_next_ay);
+}
+
+////////
+
+void ensemble::_update_distances(void)
+{
+    int n = _card * _members;
+
+    OMP(simd)
+    for(int i = 0; i < n; i++)
+    {
+        double distance = sqrt(_x[i] * _x[i] + _y[i] * _y[i]);
+
+        _min_distance[i] = min(_min_distance[i], distance);
+        _max_distance[i] = max(_max_distance[i], distance);
+    }
+}
+
+////////
+
+//  one text file per body and per member, named by the body and the member: "earth 0", "earth 1"...
+//  with the columns of the files of solver::verlet
+void ensemble::_open_output(const std::string folder, const double years)
+{
+    _output.open(folder, bodies());
+    _files.clear();
+
+    for(int e = 0; e < _members; e++)
+    {
+        for(int k = 0; k < _card; k++)
+        {
+            ofstream& output = _output.file(_names[k] + " " + to_string(e));
+
+            output << "Velocity-Verlet algorithm (2D), ensemble" << '\n';
+            output << _names[k] << " (x, y, vx, vy), member " << e << ", force exponent " << _power[e] << '\n';
+            output << "Timestep: " << years << " years" << '\n' << '\n';
+
+            _files.push_back(&output);
+        }
+    }
+}
+
+////////
+
+void ensemble::_write_positions(void)
+{
+    string space = "        ";
+
+    for(int e = 0; e < _members; e++)
+    {
+        for(int k = 0; k < _card; k++)
+        {
+            ofstream& output = *_files[e * _card + k];
+            int i = k * _members + e;
+
+            output << setprecision(12) << _x[i] << space << _y[i] << space;
+            output << setprecision(12) << _vx[i] << space << _vy[i] << space << '\n';
+        }
+    }
+}
+
+////////
+
+//  one line per member: its force exponent, its energy error, and the distances of each body to the origin
+void ensemble::_write_diagnostics(const std::string folder) const
+{
+    ofstream output(folder + "ensemble-diagnostics");
+    string space = "        ";
+
+    output << "member" << space << "exponent" << space << "energy error";
+    for(int k = 0; k < _card; k++)
+    {
+        output << space << _names[k] << " min" << space << _names[k] << " max";
+    }
+    output << '\n';
+
+    for(int e = 0; e < _members; e++)
+    {
+        output << e << space << _power[e] << space << setprecision(12) << _energy_error[e];
+
+        for(int k = 0; k < _card; k++)
+        {
+            output << space << min_distance(e, k) << space << max_distance(e, k);
+        }
+        output << '\n';
+    }
+}
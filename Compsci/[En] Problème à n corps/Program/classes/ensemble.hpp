@@ -0,0 +1,92 @@
+//
+//  ensemble.hpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include "planet.hpp"
+#include "trajectory.hpp"
+#include "kernels.hpp"
+
+
+//  many copies (the members) of the same small system, integrated together with velocity Verlet
+//  each member can have its own initial velocities and its own force exponent, like the escape velocity
+//  and the power variation studies of the 2-body model, which needed one run of solver::verlet per value
+//  the coordinates of the body k in the member e are at k * members + e: the loops over the members are innermost
+//  so each SIMD lane computes one member, the pairs of bodies are the same for all of them
+//  with AVX2 (checked at runtime like in kernels.hpp) 4 members are computed at once, with the same results
+
+class ensemble
+{
+
+public:
+
+    //  constructors
+
+    ensemble(const int members);
+
+    //  main algorithm
+
+    void verlet(const double years, const std::string folder, const int steps = 365);  //  steps per year
+
+    //  getters
+
+    int members(void) const;
+    int size(void) const;   //  number of bodies in each member
+    double time(void) const;
+    planet body(const int e, const int k) const;    //  the body k of the member e
+    double energy(const int e) const;   //  total energy of the member e, each pair counted once
+    double energy_error(const int e) const; //  relative change of the energy of the member e during the last run, absolute if it was 0
+    double min_distance(const int e, const int k) const;    //  distances of the body k to the origin during the last run
+    double max_distance(const int e, const int k) const;
+
+    //  methods
+
+    void add(planet body);  //  the same body in every member, the mass center stays fixed, see solver::add
+    void velocity(const int e, const int k, const double vx, const double vy);  //  in AU/day, like planet
+    void exponent(const int e, const double power);  //  the acceleration is -G m r / |r|^power, 3 (Newton) by default
+
+
+private:
+
+    //  data
+
+    int _members;
+    kernel_level _level;    //  vectorized or not, see kernel_best
+    int _card;  //  number of bodies in each member
+    double _time;
+    std::vector<std::string> _names;
+    std::vector<double> _m; //  one per body, the same in every member
+    std::vector<double> _power; //  one per member
+    std::vector<double> _x; //  the others have _card * _members values
+    std::vector<double> _y;
+    std::vector<double> _vx;
+    std::vector<double> _vy;
+    std::vector<double> _ax;
+    std::vector<double> _ay;
+    std::vector<double> _next_ax;
+    std::vector<double> _next_ay;
+    std::vector<double> _mobile;    //  0 for the bodies fixed at the origin, 1 for the others
+    std::vector<double> _min_distance;
+    std::vector<double> _max_distance;
+    std::vector<double> _start_energy;  //  one per member
+    std::vector<double> _energy_error;
+    trajectory _output;
+    std::vector<std::ofstream*> _files;
+
+    //  methods
+
+    void _acceleration(void);   //  fills _next_ax and _next_ay
+    void _step(const double h);
+    void _update_distances(void);
+    void _open_output(const std::string folder, const double years);
+    void _write_positions(void);
+    void _write_diagnostics(const std::string folder) const;
+};
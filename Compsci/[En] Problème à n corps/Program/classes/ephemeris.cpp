@@ -0,0 +1,201 @@
+//
+//  ephemeris.cpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#include "ephemeris.hpp"
+#include <iostream>
+#include <string>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+
+//  constructors
+
+ephemeris::ephemeris(const std::string path)
+{
+    int descriptor;
+    struct stat status;
+    void* data;
+
+    descriptor = open(path.c_str(), O_RDONLY);
+
+    if(descriptor < 0 || fstat(descriptor, &status) != 0 || (size_t) status.st_size < sizeof(ephemeris_header))
+    {
+        cout << "Can't read the ephemeris " << path << endl;
+        exit(1);
+    }
+
+    _length = (size_t) status.st_size;
+    data = mmap(nullptr, _length, PROT_READ, MAP_SHARED, descriptor, 0);
+    close(descriptor);  //  the mapping stays valid
+
+    if(data == MAP_FAILED)
+    {
+        cout << "Can't map the ephemeris " << path << endl;
+        exit(1);
+    }
+
+    _data = (const char*) data;
+    _header = (const ephemeris_header*) _data;
+
+    if(memcmp(_header->magic, "NBODYEPH", 8) != 0 || _header->version != 1)
+    {
+        cout << path << " is not an ephemeris" << endl;
+        exit(1);
+    }
+
+    //  the records must begin after the names and hold the x and y coefficients of each body
+    size_t names_end = sizeof(ephemeris_header) + (size_t) _header->bodies * ephemeris_name_size;
+    size_t record_size = 2 * (size_t) _header->bodies * _header->coefficients * sizeof(double);
+
+    if(record_size == 0 || _header->record_size != record_size || _header->record_offset < names_end || _header->record_offset > _length || !(_header->span > 0.))
+    {
+        cout << "The header of the ephemeris " << path << " is damaged" << endl;
+        exit(1);
+    }
+
+    _size = (int) ((_length - _header->record_offset) / _header->record_size);
+
+    if(_size == 0)
+    {
+        cout << "The ephemeris " << path << " is empty" << endl;
+        exit(1);
+    }
+}
+
+////////
+
+ephemeris::~ephemeris(void)
+{
+    munmap((void*) _data, _length);
+}
+
+//  getters
+
+int ephemeris::size(void) const
+{
+    return (_size);
+}
+
+////////
+
+int ephemeris::bodies(void) const
+{
+    return ((int) _header->bodies);
+}
+
+////////
+
+int ephemeris::coefficients(void) const
+{
+    return ((int) _header->coefficients);
+}
+
+////////
+
+double ephemeris::start(void) const
+{
+    return (_header->start);
+}
+
+////////
+
+double ephemeris::end(void) const
+{
+    return (_header->start + _size * _header->span);
+}
+
+////////
+
+double ephemeris::span(void) const
+{
+    return (_header->span);
+}
+
+////////
+
+std::string ephemeris::name(const int k) const
+{
+    const char* name = _data + sizeof(ephemeris_header) + k * ephemeris_name_size;
+
+    return (string(name, strnlen(name, ephemeris_name_size)));
+}
+
+////////
+
+int ephemeris::index(const std::string name) const
+{
+    for(int k = 0; k < bodies(); k++)
+    {
+        if(this->name(k) == name)
+        {
+            return (k);
+        }
+    }
+
+    return (-1);
+}
+
+//  methods
+
+std::array<double, 4> ephemeris::state(const int k, const double t) const
+{
+    if(k < 0 || k >= bodies())
+    {
+        cout << "There is no body " << k << " in the ephemeris" << endl;
+        exit(1);
+    }
+
+    int n = coefficients();
+    int r = (int) floor((t - start()) / span());
+    const double* cx;
+    const double* cy;
+    double x, t0, t1, t2, d0, d1, d2;
+    array<double, 4> state = {0., 0., 0., 0.};
+
+    r = (r < 0) ? 0 : ((r >= _size) ? _size - 1 : r);
+    cx = (const double*) (_data + _header->record_offset + (size_t) r * _header->record_size) + 2 * n * k;
+    cy = cx + n;
+
+    //  time in [-1, 1] in the span
+    x = 2. * (t - start() - r * span()) / span() - 1.;
+
+    //  T_k(x) and their derivatives, with T_k+1 = 2 x T_k - T_k-1
+    t0 = 1.;
+    t1 = x;
+    d0 = 0.;
+    d1 = 1.;
+
+    for(int i = 0; i < n; i++)
+    {
+        state[0] += cx[i] * t0;
+        state[1] += cy[i] * t0;
+        state[2] += cx[i] * d0;
+        state[3] += cy[i] * d0;
+
+        t2 = 2. * x * t1 - t0;
+        d2 = 2. * t1 + 2. * x * d1 - d0;
+        t0 = t1;
+        t1 = t2;
+        d0 = d1;
+        d1 = d2;
+    }
+
+    //  dx/dt = 2 / span
+    state[2] *= 2. / span();
+    state[3] *= 2. / span();
+
+    return (state);
+}
@@ -0,0 +1,83 @@
+//
+//  ephemeris.hpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#pragma once
+#include <string>
+#include <array>
+#include <cstdint>
+
+
+//  binary ephemeris written by euler and verlet (see solver::chebyshev), in the byte order of the machine
+//  like the JPL DE files, the run is cut in spans of the same length, and in each span the coordinates
+//  of each body are a sum of Chebyshev polynomials, whose coefficients are stored
+//
+//  header              sizeof(ephemeris_header) bytes
+//  names               bodies * 32 chars, completed with '\0'
+//  records             record_size bytes each, the span r begins at record_offset + r * record_size
+//                      for each body the coefficients of x, then the coefficients of y
+//
+//  the number of records is given by the size of the file, like in snapshots.hpp
+
+struct ephemeris_header
+{
+    char magic[8];  //  "NBODYEPH"
+    std::uint32_t version;
+    std::uint32_t bodies;
+    std::uint32_t coefficients; //  per coordinate, the degree of the polynomials is coefficients - 1
+    std::uint32_t reserved;
+    double start;   //  time of the beginning of the first span, in years
+    double span;    //  length of the spans, in years
+    std::uint64_t record_offset;
+    std::uint64_t record_size;
+};
+
+static const int ephemeris_name_size = 32;
+
+
+//  read-only view of an ephemeris mapped in memory
+//  the position and the velocity of a body at any time cost one sum of coefficients terms, whatever the length of the run
+
+class ephemeris
+{
+
+public:
+
+    //  constructors
+
+    ephemeris(const std::string path);
+    ephemeris(const ephemeris& other) = delete;
+    ~ephemeris(void);
+
+    //  getters
+
+    int size(void) const;   //  number of spans
+    int bodies(void) const;
+    int coefficients(void) const;
+    double start(void) const;
+    double end(void) const;
+    double span(void) const;
+    std::string name(const int k) const;
+    int index(const std::string name) const;    //  -1 if there is no such body
+
+    //  methods
+
+    //  (x, y, vx, vy) of the body k, which must exist, at the time t, in AU and AU/year like in the solver
+    //  out of [start, end], the first or the last span is extrapolated
+    std::array<double, 4> state(const int k, const double t) const;
+
+
+private:
+
+    //  data
+
+    const char* _data;
+    size_t _length;
+    const ephemeris_header* _header;
+    int _size;
+};
@@ -0,0 +1,112 @@
+//
+//  kepler.cpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#include "kepler.hpp"
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+
+
+//  Stumpff functions c2(z) = (1 - cos(sqrt(z))) / z and c3(z) = (sqrt(z) - sin(sqrt(z))) / sqrt(z)^3
+//  near 0 these formulas lose all their digits, so we use the series instead
+static void stumpff(const double z, double& c2, double& c3)
+{
+    if(fabs(z) < 1.)
+    {
+        double term2 = 0.5;
+        double term3 = 1. / 6.;
+
+        c2 = 0.;
+        c3 = 0.;
+
+        for(int k = 0; k < 12; k++)
+        {
+            c2 += term2;
+            c3 += term3;
+            term2 *= -z / ((2 * k + 3) * (2 * k + 4));
+            term3 *= -z / ((2 * k + 4) * (2 * k + 5));
+        }
+    }
+    else if(z > 0.)
+    {
+        double root = sqrt(z);
+
+        c2 = (1. - cos(root)) / z;
+        c3 = (root - sin(root)) / (z * root);
+    }
+    else
+    {
+        double root = sqrt(-z);
+
+        c2 = (cosh(root) - 1.) / (-z);
+        c3 = (sinh(root) - root) / (-z * root);
+    }
+}
+
+////////
+
+void kepler_drift(const double mu, const double dt, double& x, double& y, double& vx, double& vy)
+{
+    double sqrt_mu = sqrt(mu);
+    double r0 = sqrt(x * x + y * y);
+    double alpha = 2. / r0 - (vx * vx + vy * vy) / mu;  //  1 / semi-major axis, negative for a hyperbola
+    double sigma = (x * vx + y * vy) / sqrt_mu;
+    double chi; //  universal anomaly
+    double z, c2, c3;
+    double r = r0;
+    double f, g, f_dot, g_dot;
+    double new_x, new_y;
+    bool converged = false;
+
+    //  exact for a circular orbit
+    chi = (alpha > 0.) ? sqrt_mu * alpha * dt : sqrt_mu * dt / r0;
+
+    //  Newton's method on Kepler's equation, whose derivative is r
+    for(int i = 0; i < 100 && !converged; i++)
+    {
+        double kepler;
+        double correction;
+
+        z = alpha * chi * chi;
+        stumpff(z, c2, c3);
+
+        r = chi * chi * c2 + sigma * chi * (1. - z * c3) + r0 * (1. - z * c2);
+        kepler = sigma * chi * chi * c2 + (1. - alpha * r0) * chi * chi * chi * c3 + r0 * chi - sqrt_mu * dt;
+        correction = kepler / r;
+        chi -= correction;
+
+        converged = fabs(correction) <= 1.E-14 * fabs(chi);
+    }
+
+    if(!converged)
+    {
+        cout << "Kepler's equation didn't converge, the time-step is too large." << endl;
+        exit(1);
+    }
+
+    z = alpha * chi * chi;
+    stumpff(z, c2, c3);
+
+    //  Lagrange's coefficients
+    f = 1. - chi * chi * c2 / r0;
+    g = dt - chi * chi * chi * c3 / sqrt_mu;
+
+    new_x = f * x + g * vx;
+    new_y = f * y + g * vy;
+    r = sqrt(new_x * new_x + new_y * new_y);
+
+    f_dot = sqrt_mu / (r * r0) * chi * (z * c3 - 1.);
+    g_dot = 1. - chi * chi * c2 / r;
+
+    vx = f_dot * x + g_dot * vx;
+    vy = f_dot * y + g_dot * vy;
+    x = new_x;
+    y = new_y;
+}
@@ -0,0 +1,18 @@
+//
+//  kepler.hpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#pragma once
+
+
+//  exact motion of a body around a fixed mass, used as the drift of solver::wisdom_holman
+//  mu is G * M, here 4 pi^2 * M with M in solar masses
+//  (x, y, vx, vy) are relative to the fixed mass, and are replaced by the values after dt
+//  the orbit can be elliptic, parabolic or hyperbolic: Kepler's equation is solved with the universal anomaly
+
+void kepler_drift(const double mu, const double dt, double& x, double& y, double& vx, double& vy);
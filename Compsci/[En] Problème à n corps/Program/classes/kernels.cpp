@@ -0,0 +1,253 @@
+//
+//  kernels.cpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#include "kernels.hpp"
+#include <cmath>
+#include <string>
+
+//  the vectorized versions need gcc or clang on a x86-64 processor
+//  each function is compiled for its own instruction set, so the program
+//  still runs on a processor without AVX: kernel_best then returns kernel_scalar
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define KERNELS_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+
+static const double g_const = 4 * M_PI * M_PI;
+
+
+//  the reference, same arithmetic as solver::_acceleration
+static void kernel_scalar_acceleration(const int n, const double* x, const double* y, const double* m, double* ax, double* ay, const int begin, const int end)
+{
+    double relative_x, relative_y, r, radical;
+
+    for(int i = begin; i < end; i++)
+    {
+        double sum_x = 0.;
+        double sum_y = 0.;
+
+        for(int j = 0; j < n; j++)
+        {
+            if(j != i)
+            {
+                relative_x = x[i] - x[j];
+                relative_y = y[i] - y[j];
+                r = sqrt(relative_x * relative_x + relative_y * relative_y);
+                radical = m[j] / (r * r * r);
+                sum_x -= radical * relative_x;
+                sum_y -= radical * relative_y;
+            }
+        }
+
+        ax[i] = g_const * sum_x;
+        ay[i] = g_const * sum_y;
+    }
+}
+
+////////
+
+#ifdef KERNELS_X86
+
+//  the pairs with r = 0, ie the body itself, are masked in the vectorized loops
+//  the last n % 4 (or n % 8) source bodies are done like in the scalar version
+static void kernel_tail(const int i, const int first, const int n, const double* x, const double* y, const double* m, double& sum_x, double& sum_y)
+{
+    double relative_x, relative_y, r, radical;
+
+    for(int j = first; j < n; j++)
+    {
+        if(j != i)
+        {
+            relative_x = x[i] - x[j];
+            relative_y = y[i] - y[j];
+            r = sqrt(relative_x * relative_x + relative_y * relative_y);
+            radical = m[j] / (r * r * r);
+            sum_x -= radical * relative_x;
+            sum_y -= radical * relative_y;
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void kernel_avx2_acceleration(const int n, const double* x, const double* y, const double* m, double* ax, double* ay, const int begin, const int end)
+{
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d three_halves = _mm256_set1_pd(1.5);
+    double lanes_x[4], lanes_y[4];
+    int last = n - n % 4;
+
+    for(int i = begin; i < end; i++)
+    {
+        __m256d xi = _mm256_set1_pd(x[i]);
+        __m256d yi = _mm256_set1_pd(y[i]);
+        __m256d sum_x = zero;
+        __m256d sum_y = zero;
+        double total_x, total_y;
+
+        for(int j = 0; j < last; j += 4)
+        {
+            __m256d relative_x = _mm256_sub_pd(xi, _mm256_loadu_pd(x + j));
+            __m256d relative_y = _mm256_sub_pd(yi, _mm256_loadu_pd(y + j));
+            __m256d r_squared = _mm256_fmadd_pd(relative_x, relative_x, _mm256_mul_pd(relative_y, relative_y));
+            __m256d mask = _mm256_cmp_pd(r_squared, zero, _CMP_GT_OQ);
+
+            //  12 bits estimation in single precision, then 3 Newton's iterations
+            //  y <- y * (3/2 - r^2 * y^2 / 2), each of them doubles the number of exact bits
+            __m256d inverse = _mm256_cvtps_pd(_mm_rsqrt_ps(_mm256_cvtpd_ps(r_squared)));
+            __m256d half_r_squared = _mm256_mul_pd(half, r_squared);
+
+            for(int newton = 0; newton < 3; newton++)
+            {
+                inverse = _mm256_mul_pd(inverse, _mm256_fnmadd_pd(half_r_squared, _mm256_mul_pd(inverse, inverse), three_halves));
+            }
+
+            inverse = _mm256_and_pd(inverse, mask);
+
+            __m256d radical = _mm256_mul_pd(_mm256_loadu_pd(m + j), _mm256_mul_pd(inverse, _mm256_mul_pd(inverse, inverse)));
+            sum_x = _mm256_fnmadd_pd(radical, relative_x, sum_x);
+            sum_y = _mm256_fnmadd_pd(radical, relative_y, sum_y);
+        }
+
+        _mm256_storeu_pd(lanes_x, sum_x);
+        _mm256_storeu_pd(lanes_y, sum_y);
+        total_x = (lanes_x[0] + lanes_x[1]) + (lanes_x[2] + lanes_x[3]);
+        total_y = (lanes_y[0] + lanes_y[1]) + (lanes_y[2] + lanes_y[3]);
+
+        kernel_tail(i, last, n, x, y, m, total_x, total_y);
+
+        ax[i] = g_const * total_x;
+        ay[i] = g_const * total_y;
+    }
+}
+
+////////
+
+__attribute__((target("avx512f")))
+static void kernel_avx512_acceleration(const int n, const double* x, const double* y, const double* m, double* ax, double* ay, const int begin, const int end)
+{
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d half = _mm512_set1_pd(0.5);
+    const __m512d three_halves = _mm512_set1_pd(1.5);
+    int last = n - n % 8;
+
+    for(int i = begin; i < end; i++)
+    {
+        __m512d xi = _mm512_set1_pd(x[i]);
+        __m512d yi = _mm512_set1_pd(y[i]);
+        __m512d sum_x = zero;
+        __m512d sum_y = zero;
+        double total_x, total_y;
+
+        for(int j = 0; j < last; j += 8)
+        {
+            __m512d relative_x = _mm512_sub_pd(xi, _mm512_loadu_pd(x + j));
+            __m512d relative_y = _mm512_sub_pd(yi, _mm512_loadu_pd(y + j));
+            __m512d r_squared = _mm512_fmadd_pd(relative_x, relative_x, _mm512_mul_pd(relative_y, relative_y));
+            __mmask8 mask = _mm512_cmp_pd_mask(r_squared, zero, _CMP_GT_OQ);
+
+            //  14 bits estimation in double precision, then 2 Newton's iterations
+            //  the lanes of r = 0 start at 0 and stay there
+            __m512d inverse = _mm512_maskz_rsqrt14_pd(mask, r_squared);
+            __m512d half_r_squared = _mm512_mul_pd(half, r_squared);
+
+            for(int newton = 0; newton < 2; newton++)
+            {
+                inverse = _mm512_mul_pd(inverse, _mm512_fnmadd_pd(half_r_squared, _mm512_mul_pd(inverse, inverse), three_halves));
+            }
+
+            __m512d radical = _mm512_mul_pd(_mm512_loadu_pd(m + j), _mm512_mul_pd(inverse, _mm512_mul_pd(inverse, inverse)));
+            sum_x = _mm512_fnmadd_pd(radical, relative_x, sum_x);
+            sum_y = _mm512_fnmadd_pd(radical, relative_y, sum_y);
+        }
+
+        //  the masked extractions don't read an undefined register, unlike _mm512_reduce_add_pd
+        __m256d half_x = _mm256_add_pd(_mm512_maskz_extractf64x4_pd(0xF, sum_x, 0), _mm512_maskz_extractf64x4_pd(0xF, sum_x, 1));
+        __m256d half_y = _mm256_add_pd(_mm512_maskz_extractf64x4_pd(0xF, sum_y, 0), _mm512_maskz_extractf64x4_pd(0xF, sum_y, 1));
+        double lanes_x[4], lanes_y[4];
+
+        _mm256_storeu_pd(lanes_x, half_x);
+        _mm256_storeu_pd(lanes_y, half_y);
+        total_x = (lanes_x[0] + lanes_x[1]) + (lanes_x[2] + lanes_x[3]);
+        total_y = (lanes_y[0] + lanes_y[1]) + (lanes_y[2] + lanes_y[3]);
+
+        kernel_tail(i, last, n, x, y, m, total_x, total_y);
+
+        ax[i] = g_const * total_x;
+        ay[i] = g_const * total_y;
+    }
+}
+
+#endif
+
+////////
+
+kernel_level kernel_best(void)
+{
+#ifdef KERNELS_X86
+    __builtin_cpu_init();
+
+    if(__builtin_cpu_supports("avx512f"))
+    {
+        return (kernel_avx512);
+    }
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    {
+        return (kernel_avx2);
+    }
+#endif
+
+    return (kernel_scalar);
+}
+
+////////
+
+std::string kernel_name(const kernel_level level)
+{
+    string name;
+
+    if(level == kernel_avx512) name = "AVX-512";
+    else if(level == kernel_avx2) name = "AVX2";
+    else name = "scalar";
+
+    return (name);
+}
+
+////////
+
+void kernel_acceleration(const int n, const double* x, const double* y, const double* m, double* ax, double* ay, const int begin, const int end)
+{
+    //  the processor is only checked once
+    static const kernel_level best = kernel_best();
+
+    kernel_acceleration(best, n, x, y, m, ax, ay, begin, end);
+}
+
+////////
+
+void kernel_acceleration(const kernel_level level, const int n, const double* x, const double* y, const double* m, double* ax, double* ay, const int begin, const int end)
+{
+#ifdef KERNELS_X86
+    if(level == kernel_avx512)
+    {
+        kernel_avx512_acceleration(n, x, y, m, ax, ay, begin, end);
+        return;
+    }
+    if(level == kernel_avx2)
+    {
+        kernel_avx2_acceleration(n, x, y, m, ax, ay, begin, end);
+        return;
+    }
+#endif
+
+    kernel_scalar_acceleration(n, x, y, m, ax, ay, begin, end);
+}
@@ -0,0 +1,27 @@
+//
+//  kernels.hpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#pragma once
+#include <string>
+
+
+//  vectorized direct summation of the Newtonian accelerations
+//  ax[i] = - 4 pi^2 * sum over j != i of m[j] * (r_i - r_j) / |r_i - r_j|^3
+//  the AVX2 version treats 4 source bodies at once, the AVX-512 version 8
+//  1/r is computed with the rsqrt instruction and refined with Newton's method
+//  so the results are the ones of solver::_acceleration up to a few rounding errors
+
+enum kernel_level {kernel_scalar, kernel_avx2, kernel_avx512};
+
+kernel_level kernel_best(void);   //  best level supported by the processor, checked at runtime
+std::string kernel_name(const kernel_level level);
+
+//  computes the accelerations of the targets begin to end - 1 due to the n bodies
+void kernel_acceleration(const int n, const double* x, const double* y, const double* m, double* ax, double* ay, const int begin, const int end);
+void kernel_acceleration(const kernel_level level, const int n, const double* x, const double* y, const double* m, double* ax, double* ay, const int begin, const int end);
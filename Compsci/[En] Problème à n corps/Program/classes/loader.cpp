@@ -0,0 +1,407 @@
+//
+//  loader.cpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#include "loader.hpp"
+#include "planet.hpp"
+#include "bodies.hpp"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+
+//  a file mapped in memory, for the time of the reading
+struct mapping
+{
+    const char* data;
+    size_t length;
+
+    mapping(const std::string path)
+    {
+        int descriptor = open(path.c_str(), O_RDONLY);
+        struct stat status;
+        void* memory = MAP_FAILED;
+
+        data = nullptr;
+        length = 0;
+
+        if(descriptor >= 0 && fstat(descriptor, &status) == 0 && status.st_size > 0)
+        {
+            length = (size_t) status.st_size;
+            memory = mmap(nullptr, length, PROT_READ, MAP_SHARED, descriptor, 0);
+        }
+
+        if(descriptor >= 0)
+        {
+            close(descriptor);  //  the mapping stays valid
+        }
+
+        if(memory != MAP_FAILED)
+        {
+            data = (const char*) memory;
+            madvise(memory, length, MADV_SEQUENTIAL);
+        }
+    }
+
+    ~mapping(void)
+    {
+        if(data != nullptr)
+        {
+            munmap((void*) data, length);
+        }
+    }
+};
+
+//  the lines are copied in a buffer which ends with '\0' for strtod, the end of the mapping doesn't
+static const int line_size = 1024;
+
+static const double kilometer = 1. / 149597870.7;  //  in AU
+static const double kilometer_per_second = 86400. / 149597870.7;  //  in AU/day
+
+
+static const char* find(const char* begin, const char* end, const char* text)
+{
+    return (search(begin, end, text, text + strlen(text)));
+}
+
+////////
+
+//  copies the line which begins at begin, and returns the beginning of the next one
+static const char* copy_line(const char* begin, const char* end, char* line)
+{
+    const char* stop = (const char*) memchr(begin, '\n', end - begin);
+    size_t length;
+
+    stop = (stop == nullptr) ? end : stop;
+    length = min((size_t) (stop - begin), (size_t) line_size - 1);
+    memcpy(line, begin, length);
+    line[length] = '\0';
+
+    return ((stop == end) ? end : stop + 1);
+}
+
+////////
+
+static void add_body(bodies& table, const std::string& name, const double mass, const double* values)
+{
+    table.name.push_back(name);
+    table.m.push_back(mass);
+    table.x.push_back(values[0]);
+    table.y.push_back(values[1]);
+    table.vx.push_back(values[2]);
+    table.vy.push_back(values[3]);
+}
+
+////////
+
+static bool read_binary(const mapping& file, bodies& table)
+{
+    const table_header* header = (const table_header*) file.data;
+    size_t n = header->bodies;
+    const double* arrays = (const double*) (file.data + sizeof(table_header) + n * table_name_size);
+
+    if(header->version != 1 || file.length < sizeof(table_header) + n * (table_name_size + 5 * sizeof(double)))
+    {
+        return (false);
+    }
+
+    table.name.resize(n);
+
+    for(size_t k = 0; k < n; k++)
+    {
+        const char* name = file.data + sizeof(table_header) + k * table_name_size;
+        table.name[k].assign(name, strnlen(name, table_name_size));
+    }
+
+    table.m.assign(arrays, arrays + n);
+    table.x.assign(arrays + n, arrays + 2 * n);
+    table.y.assign(arrays + 2 * n, arrays + 3 * n);
+    table.vx.assign(arrays + 3 * n, arrays + 4 * n);
+    table.vy.assign(arrays + 4 * n, arrays + 5 * n);
+
+    return (true);
+}
+
+////////
+
+//  name, mass, x, y, vx, vy
+static bool read_csv(const mapping& file, bodies& table)
+{
+    const char* end = file.data + file.length;
+    const char* next = file.data;
+    char line[line_size];
+    string name;
+    size_t lines = count(file.data, end, '\n') + 1;
+
+    table.name.reserve(lines);
+    table.m.reserve(lines);
+    table.x.reserve(lines);
+    table.y.reserve(lines);
+    table.vx.reserve(lines);
+    table.vy.reserve(lines);
+
+    while(next < end)
+    {
+        next = copy_line(next, end, line);
+
+        char* comma = strchr(line, ',');
+        char* field;
+        char* stop;
+        double mass = 0.;
+        double values[4];
+        bool valid = (comma != nullptr && line[0] != '#');
+
+        for(int i = 0; i < 5 && valid; i++)
+        {
+            field = (i == 0) ? comma + 1 : stop + 1;
+            double value = strtod(field, &stop);
+
+            //  the header of the columns, or a line of text
+            valid = (stop != field);
+
+            while(*stop == ' ' || *stop == '\t')
+            {
+                stop++;
+            }
+            valid = valid && (i == 4 || *stop == ',');
+
+            if(i == 0)
+            {
+                mass = value;
+            }
+            else
+            {
+                values[i - 1] = value;
+            }
+        }
+
+        if(!valid)
+        {
+            continue;
+        }
+
+        char* first = line;
+        char* last = comma;
+
+        while(*first == ' ' || *first == '\t')
+        {
+            first++;
+        }
+        while(last > first && (last[-1] == ' ' || last[-1] == '\t'))
+        {
+            last--;
+        }
+
+        name.assign(first, last - first);
+        add_body(table, name, mass, values);
+    }
+
+    return (table.size() > 0);
+}
+
+////////
+
+//  the first line of a VECTORS table, after $$SOE
+static bool read_horizons(const mapping& file, const std::string path, const double mass, bodies& table)
+{
+    const char* end = file.data + file.length;
+    const char* start = find(file.data, end, "$$SOE");
+    const char* units = find(file.data, start, "Output units");
+    const char* target = find(file.data, start, "Target body name:");
+    char record[line_size];
+    char line[line_size];
+    double values[4];
+    const char* labels[4] = {"X =", "Y =", "VX=", "VY="};
+    string name;
+
+    if(start == end)
+    {
+        return (false);
+    }
+
+    //  the file doesn't give it, and a body without mass would break the mass center
+    if(!(mass > 0.))
+    {
+        cout << "The mass of the body of the Horizons file " << path << " must be given, in kg" << endl;
+        exit(1);
+    }
+
+    //  the date, then the values on the next lines, or everything on one line in the CSV layout
+    const char* next = copy_line(start, end, line);
+    size_t length = min((size_t) (end - next), (size_t) line_size - 1);
+    memcpy(record, next, length);
+    record[length] = '\0';
+    copy_line(next, end, line);
+
+    if(strchr(line, ',') != nullptr)
+    {
+        //  JDTDB, calendar date, X, Y, Z, VX, VY, VZ
+        char* field = line;
+        double csv[6];
+
+        for(int i = 0; i < 8; i++)
+        {
+            char* stop;
+
+            if(i >= 2)
+            {
+                csv[i - 2] = strtod(field, &stop);
+                if(stop == field)
+                {
+                    return (false);
+                }
+            }
+
+            field = strchr(field, ',');
+            if(field == nullptr && i < 7)
+            {
+                return (false);
+            }
+            field = (field == nullptr) ? nullptr : field + 1;
+        }
+
+        values[0] = csv[0];
+        values[1] = csv[1];
+        values[2] = csv[3];
+        values[3] = csv[4];
+    }
+    else
+    {
+        char* field = record;
+
+        for(int i = 0; i < 4; i++)
+        {
+            char* stop;
+
+            field = strstr(field, labels[i]);
+            if(field == nullptr)
+            {
+                return (false);
+            }
+
+            field += strlen(labels[i]);
+            values[i] = strtod(field, &stop);
+            if(stop == field)
+            {
+                return (false);
+            }
+            field = stop;
+        }
+    }
+
+    if(units != start)
+    {
+        copy_line(units, start, line);
+
+        if(strstr(line, "KM-S") != nullptr)
+        {
+            values[0] *= kilometer;
+            values[1] *= kilometer;
+            values[2] *= kilometer_per_second;
+            values[3] *= kilometer_per_second;
+        }
+    }
+
+    //  "Target body name: Mars (499)" gives "mars", like the names of initialisations.hpp
+    if(target != start)
+    {
+        copy_line(target + strlen("Target body name:"), start, line);
+
+        char* first = line;
+        char* last = line;
+
+        while(*first == ' ')
+        {
+            first++;
+        }
+        for(last = first; *last != '\0' && *last != '(' && *last != '{'; last++)
+        {
+        }
+        while(last > first && last[-1] == ' ')
+        {
+            last--;
+        }
+
+        name.assign(first, last - first);
+    }
+    else
+    {
+        name = path.substr(path.find_last_of('/') + 1);
+    }
+
+    transform(name.begin(), name.end(), name.begin(), [](unsigned char c) {return ((char) tolower(c));});
+    add_body(table, name, mass, values);
+
+    return (true);
+}
+
+////////
+
+bool read_table(const std::string path, const double mass, bodies& table)
+{
+    mapping file(path);
+
+    if(file.data == nullptr)
+    {
+        return (false);
+    }
+
+    if(file.length >= sizeof(table_header) && memcmp(file.data, "NBODYTAB", 8) == 0)
+    {
+        return (read_binary(file, table));
+    }
+
+    if(find(file.data, file.data + file.length, "$$SOE") != file.data + file.length)
+    {
+        return (read_horizons(file, path, mass, table));
+    }
+
+    return (read_csv(file, table));
+}
+
+////////
+
+void write_table(const std::string path, const std::vector<planet>& table)
+{
+    ofstream file(path, ios::out | ios::binary);
+    table_header header;
+    int n = (int) table.size();
+    vector<char> names(n * table_name_size, '\0');
+    vector<double> arrays(5 * n);
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "NBODYTAB", 8);
+    header.version = 1;
+    header.bodies = n;
+
+    for(int k = 0; k < n; k++)
+    {
+        //  the names are cut at 31 characters
+        strncpy(names.data() + k * table_name_size, table[k].name().c_str(), table_name_size - 1);
+        arrays[k] = table[k].mass();
+        arrays[n + k] = table[k].position[0];
+        arrays[2 * n + k] = table[k].position[1];
+        arrays[3 * n + k] = table[k].velocity[0];
+        arrays[4 * n + k] = table[k].velocity[1];
+    }
+
+    file.write((const char*) &header, sizeof(header));
+    file.write(names.data(), names.size());
+    file.write((const char*) arrays.data(), arrays.size() * sizeof(double));
+}
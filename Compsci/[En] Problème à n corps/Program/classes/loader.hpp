@@ -0,0 +1,37 @@
+//
+//  loader.hpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "planet.hpp"
+#include "bodies.hpp"
+
+
+//  initial conditions read from a file (see solver::load), in the units of planet: kg, AU and AU/day
+//  the file is mapped in memory and read in one pass, the format is recognized by its content
+//
+//  binary table        header (sizeof(table_header) bytes), names (bodies * 32 chars, completed with '\0')
+//                      then the arrays m, x, y, vx, vy of bodies doubles, in the byte order of the machine
+//  Horizons            a VECTORS table of the JPL Horizons system, for one body, with the first line after $$SOE
+//                      in the text or in the CSV layout, in AU-D or KM-S; its mass is not in the file and must be given
+//  CSV                 one body per line: name, mass, x, y, vx, vy; the lines which don't begin like this are skipped
+
+struct table_header
+{
+    char magic[8];  //  "NBODYTAB"
+    std::uint32_t version;
+    std::uint32_t bodies;
+};
+
+static const int table_name_size = 32;
+
+bool read_table(const std::string path, const double mass, bodies& table);  //  fills name, m, x, y, vx and vy only; false if the file can't be read
+void write_table(const std::string path, const std::vector<planet>& table);  //  binary table
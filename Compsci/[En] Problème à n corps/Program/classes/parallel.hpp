@@ -0,0 +1,23 @@
+//
+//  parallel.hpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#pragma once
+
+
+//  OpenMP directives which vanish when the program is compiled without -fopenmp
+//  instead of giving one -Wunknown-pragmas warning each; the loops then run on one thread
+//  OMP(parallel for schedule(static)) stands for #pragma omp parallel for schedule(static)
+
+#define OMP_STRING(...) #__VA_ARGS__
+
+#ifdef _OPENMP
+#define OMP(...) _Pragma(OMP_STRING(omp __VA_ARGS__))
+#else
+#define OMP(...)
+#endif
@@ -18,41 +18,60 @@ using namespace std;
 
 //  constructors
 
-planet::planet(void)
+template <int D, typename T>
+basic_planet<D, T>::basic_planet(void)
 {
+    static_assert(D == 2 || D == 3, "a planet has 2 or 3 dimensions");
 
     time = 0;
     _name = "AUTO NAMING";
-    _dim = 2;
     _mass = 1.;
 
-    position = {1., 0.};
-    velocity = {0., 0.};
+    position.fill(0.);
+    velocity.fill(0.);
+    position[0] = 1.;
 }
 
 ////////
 
-planet::planet(std::string name, double mass, double x, double y, double vx, double vy)
+template <int D, typename T>
+basic_planet<D, T>::basic_planet(std::string name, T mass, T x, T y, T vx, T vy)
 {
     time = 0.;
     _name = name;
-    _dim = 2;
-    _mass = (double) mass;
+    _mass = mass;
 
-    position = {(double) x, (double) y};
-    velocity = {(double) vx, (double) vy};
+    position.fill(0.);
+    velocity.fill(0.);
+    position[0] = x;
+    position[1] = y;
+    velocity[0] = vx;
+    velocity[1] = vy;
 
     time = 0;
 }
 
 ////////
 
-planet::planet(const planet& body)
+template <int D, typename T>
+basic_planet<D, T>::basic_planet(std::string name, T mass, const std::array<T, D>& position, const std::array<T, D>& velocity)
 {
-    time = (double) body.time;
+    time = 0.;
+    _name = name;
+    _mass = mass;
+
+    this->position = position;
+    this->velocity = velocity;
+}
+
+////////
+
+template <int D, typename T>
+basic_planet<D, T>::basic_planet(const basic_planet& body)
+{
+    time = body.time;
     _name = body._name;
-    _dim = (double) body._dim;
-    _mass = (double) body._mass;
+    _mass = body._mass;
 
     position = body.position;
     velocity = body.velocity;
@@ -61,33 +80,37 @@ planet::planet(const planet& body)
 
 //  getters
 
-int planet::dim(void) const
+template <int D, typename T>
+int basic_planet<D, T>::dim(void) const
 {
-    return (_dim);
+    return (D);
 }
 
 ////////
 
-double planet::mass(void) const
+template <int D, typename T>
+T basic_planet<D, T>::mass(void) const
 {
     return (_mass);
 }
 
 ////////
 
-std::string planet::name(void) const
+template <int D, typename T>
+std::string basic_planet<D, T>::name(void) const
 {
     return (_name);
 }
 
 //  methods
 
-double planet::distance(const planet& body) const
+template <int D, typename T>
+T basic_planet<D, T>::distance(const basic_planet& body) const
 {
-    double sum = 0.;
-    double relative_position;
+    T sum = 0.;
+    T relative_position;
 
-    for(int i = 0; i < _dim; i++)
+    for(int i = 0; i < D; i++)
     {
         relative_position = position[i] - body.position[i];
         sum += relative_position * relative_position;
@@ -98,11 +121,12 @@ double planet::distance(const planet& body) const
 
 ////////
 
-double planet::distance_center(void) const
+template <int D, typename T>
+T basic_planet<D, T>::distance_center(void) const
 {
-    double sum = 0.;
+    T sum = 0.;
 
-    for(int i = 0; i < _dim; i++)
+    for(int i = 0; i < D; i++)
     {
         sum += position[i] * position[i];
     }
@@ -112,9 +136,10 @@ double planet::distance_center(void) const
 
 ////////
 
-double planet::kinetic_energy(void) const
+template <int D, typename T>
+T basic_planet<D, T>::kinetic_energy(void) const
 {
-    double energy = 0.5 * _mass * velocity_squared();
+    T energy = 0.5 * _mass * velocity_squared();
     
     return (energy);
 }
@@ -122,13 +147,14 @@ double planet::kinetic_energy(void) const
 ////////
 
 //  the potential energy is with respect to another body
-double planet::potential_energy(const planet& body) const
+template <int D, typename T>
+T basic_planet<D, T>::potential_energy(const basic_planet& body) const
 {
-    double energy;
+    T energy;
     
     if(distance(body) != 0.)
     {
-        double r = distance(body);
+        T r = distance(body);
         
         energy = (4 * M_PI * M_PI * _mass * body._mass) / (r*r);
     }
@@ -144,9 +170,10 @@ double planet::potential_energy(const planet& body) const
 
 //  we can calculate it for many planets
 //  this one is usefull for solver::potential_energy
-double planet::potential_energy(const std::vector<planet>& system) const
+template <int D, typename T>
+T basic_planet<D, T>::potential_energy(const std::vector<basic_planet>& system) const
 {
-    double energy = 0.;
+    T energy = 0.;
 
     for(auto& body : system)
     {
@@ -158,29 +185,32 @@ double planet::potential_energy(const std::vector<planet>& system) const
 
 ////////
 
-double planet::total_energy(const planet& body) const
+template <int D, typename T>
+T basic_planet<D, T>::total_energy(const basic_planet& body) const
 {
-    double energy = kinetic_energy() + potential_energy(body);
+    T energy = kinetic_energy() + potential_energy(body);
     
     return (energy);
 }
 
 ////////
 
-double planet::total_energy(const std::vector<planet>& system) const
+template <int D, typename T>
+T basic_planet<D, T>::total_energy(const std::vector<basic_planet>& system) const
 {
-    double energy = kinetic_energy() + potential_energy(system);
+    T energy = kinetic_energy() + potential_energy(system);
 
     return (energy);
 }
 
 ////////
 
-double planet::velocity_squared(void) const
+template <int D, typename T>
+T basic_planet<D, T>::velocity_squared(void) const
 {
-    double v = 0.;
+    T v = 0.;
     
-    for(int i = 0; i < _dim; i++)
+    for(int i = 0; i < D; i++)
     {
         v += velocity[i] * velocity[i];
     }
@@ -190,30 +220,34 @@ double planet::velocity_squared(void) const
 
 ////////
 
-void planet::normalize(void)
+template <int D, typename T>
+void basic_planet<D, T>::normalize(void)
 {
     //  the program is made to work with NASA's data
     //  the velocities are given in AU/day
     _mass /= 2.E30;
-    velocity[0] *= 365.25;
-    velocity[1] *= 365.25;
+    for(int i = 0; i < D; i++)
+    {
+        velocity[i] *= 365.25;
+    }
 }
 
 ////////
 
-void planet::print(std::ofstream& output) const
+template <int D, typename T>
+void basic_planet<D, T>::print(std::ofstream& output) const
 {
     output << _name << endl;
     output << _mass << "kg" << endl;
     output << "At t=" << time << " years" << endl;
 
     output << "Position: " << endl;
-    for(int i = 0; i < _dim; i++)
+    for(int i = 0; i < D; i++)
     {
         output << setprecision(12) << position[i] << endl;
     }
     output << "Velocity: " << endl;
-    for(int i = 0; i < _dim; i++)
+    for(int i = 0; i < D; i++)
     {
         output << setprecision(12) << velocity[i] << endl;
     }
@@ -224,7 +258,8 @@ void planet::print(std::ofstream& output) const
 
 ////////
 
-void planet::print(std::ofstream& output, const std::vector<planet>& system) const
+template <int D, typename T>
+void basic_planet<D, T>::print(std::ofstream& output, const std::vector<basic_planet>& system) const
 {
     output << _name << endl;
     output << _mass << "kg" << endl;
@@ -234,12 +269,12 @@ void planet::print(std::ofstream& output, const std::vector<planet>& system) con
     output << "Total energy: " << total_energy(system) << endl;
 
     output << "Position: " << endl;
-    for(int i = 0; i < _dim; i++)
+    for(int i = 0; i < D; i++)
     {
         output << setprecision(12) << position[i] << endl;
     }
     output << "Velocity: " << endl;
-    for(int i = 0; i < _dim; i++)
+    for(int i = 0; i < D; i++)
     {
         output << setprecision(12) << velocity[i] << endl;
     }
@@ -253,11 +288,12 @@ void planet::print(std::ofstream& output, const std::vector<planet>& system) con
 //  those ones are useful for Verlet and Euler
 //  they are made to have clean columns in output files
 
-void planet::print_pos(std::ofstream& output) const
+template <int D, typename T>
+void basic_planet<D, T>::print_pos(std::ofstream& output) const
 {
     string space = "        ";
 
-    for(int i = 0; i < _dim; i++)
+    for(int i = 0; i < D; i++)
     {
         output << setprecision(12) << position[i] << space;
     }
@@ -265,12 +301,21 @@ void planet::print_pos(std::ofstream& output) const
 
 ////////
 
-void planet::print_vel(std::ofstream& output) const
+template <int D, typename T>
+void basic_planet<D, T>::print_vel(std::ofstream& output) const
 {
     string space = "        ";
 
-    for(int i = 0; i < _dim; i++)
+    for(int i = 0; i < D; i++)
     {
         output << setprecision(12) << velocity[i] << space;
     }
 }
+
+
+template class basic_planet<2, float>;
+template class basic_planet<2, double>;
+template class basic_planet<2, long double>;
+template class basic_planet<3, float>;
+template class basic_planet<3, double>;
+template class basic_planet<3, long double>;
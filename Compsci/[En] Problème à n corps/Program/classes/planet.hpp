@@ -9,46 +9,53 @@
 
 #pragma once
 #include <vector>
+#include <array>
 #include <string>
 #include <fstream>
 
 
-class planet
+//  a celestial body in D dimensions (2 or 3), with the scalar type T (float, double or long double)
+//  the dimension is known at compile time, so the loops over the coordinates are unrolled
+//  the solver works in 2D with doubles, see the planet type below; basic_solver integrates the other ones (basic-solver.hpp)
+
+template <int D, typename T = double>
+class basic_planet
 {
 
 public:
 
     //  constructors
 
-    planet(void);
-    planet(std::string name, double mass, double x, double y, double vx, double vy);
-    planet(const planet& body);
+    basic_planet(void);
+    basic_planet(std::string name, T mass, T x, T y, T vx, T vy);  //  in the plane z = 0 in 3D
+    basic_planet(std::string name, T mass, const std::array<T, D>& position, const std::array<T, D>& velocity);
+    basic_planet(const basic_planet& body);
 
     //  data
 
-    double time;   //  in years
-    std::vector<double> position;
-    std::vector<double> velocity;
+    T time;   //  in years
+    std::array<T, D> position;
+    std::array<T, D> velocity;
 
     //  getters
 
     int dim(void) const;  //  dimension of the vectors (2 or 3)
-    double mass(void) const;
+    T mass(void) const;
     std::string name(void) const;
 
     //  methods
 
-    double distance(const planet& body) const;  //  distance to the other planet
-    double distance_center(void) const; //  distance to the origin
-    double kinetic_energy(void) const;
-    double potential_energy(const planet& body) const;
-    double potential_energy(const std::vector<planet>& system) const;
-    double total_energy(const planet& body) const;
-    double total_energy(const std::vector<planet>& system) const;
-    double velocity_squared(void) const;    //  square of the velocity norm
+    T distance(const basic_planet& body) const;  //  distance to the other planet
+    T distance_center(void) const; //  distance to the origin
+    T kinetic_energy(void) const;
+    T potential_energy(const basic_planet& body) const;
+    T potential_energy(const std::vector<basic_planet>& system) const;
+    T total_energy(const basic_planet& body) const;
+    T total_energy(const std::vector<basic_planet>& system) const;
+    T velocity_squared(void) const;    //  square of the velocity norm
     void normalize(void);   //  normalize with the good time & distance units
     void print(std::ofstream& output) const;  //  outputs position and velocity
-    void print(std::ofstream& output, const std::vector<planet>& system) const;  //  idem + energies
+    void print(std::ofstream& output, const std::vector<basic_planet>& system) const;  //  idem + energies
     void print_pos(std::ofstream& output) const;  //  used by the solver class
     void print_vel(std::ofstream& output) const;  //  idem
 
@@ -57,7 +64,17 @@ private:
 
     //  data
 
-    int _dim;
-    double _mass;
+    T _mass;
     std::string _name;
 };
+
+
+//  compiled in planet.cpp for these dimensions and types
+typedef basic_planet<2, double> planet;
+
+extern template class basic_planet<2, float>;
+extern template class basic_planet<2, double>;
+extern template class basic_planet<2, long double>;
+extern template class basic_planet<3, float>;
+extern template class basic_planet<3, double>;
+extern template class basic_planet<3, long double>;
@@ -0,0 +1,127 @@
+//
+//  ring.hpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#pragma once
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+
+//  bounded lock-free queue between one producer thread and one consumer thread
+//  the slots are allocated once, the producer fills them in place:
+//
+//      T* slot = queue.reserve();  //  nullptr if the queue is full
+//      ... fill *slot ...
+//      queue.publish();
+//
+//  and the consumer reads them in the same order:
+//
+//      T* slot = queue.front();    //  nullptr if the queue is empty
+//      ... read *slot ...
+//      queue.pop();
+
+template <typename T>
+class ring
+{
+
+public:
+
+    //  constructors
+
+    ring(const int capacity);   //  rounded up to a power of two
+
+    //  getters
+
+    int capacity(void) const;
+    bool empty(void) const; //  every published slot has been popped, from either thread
+
+    //  methods
+
+    T* reserve(void);
+    void publish(void);
+    T* front(void);
+    void pop(void);
+
+
+private:
+
+    //  data
+
+    std::vector<T> _slots;
+    std::size_t _mask;
+    alignas(64) std::atomic<std::size_t> _head;    //  next slot written by the producer
+    alignas(64) std::atomic<std::size_t> _tail;    //  next slot read by the consumer
+};
+
+
+template <typename T>
+ring<T>::ring(const int capacity)
+{
+    std::size_t size = 1;
+
+    while(size < (std::size_t) capacity)
+    {
+        size *= 2;
+    }
+
+    _slots.resize(size);
+    _mask = size - 1;
+    _head = 0;
+    _tail = 0;
+}
+
+template <typename T>
+int ring<T>::capacity(void) const
+{
+    return ((int) _slots.size());
+}
+
+template <typename T>
+bool ring<T>::empty(void) const
+{
+    return (_tail.load(std::memory_order_acquire) == _head.load(std::memory_order_acquire));
+}
+
+template <typename T>
+T* ring<T>::reserve(void)
+{
+    std::size_t head = _head.load(std::memory_order_relaxed);
+
+    if(head - _tail.load(std::memory_order_acquire) == _slots.size())
+    {
+        return (nullptr);
+    }
+
+    return (&_slots[head & _mask]);
+}
+
+template <typename T>
+void ring<T>::publish(void)
+{
+    _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+template <typename T>
+T* ring<T>::front(void)
+{
+    std::size_t tail = _tail.load(std::memory_order_relaxed);
+
+    if(tail == _head.load(std::memory_order_acquire))
+    {
+        return (nullptr);
+    }
+
+    return (&_slots[tail & _mask]);
+}
+
+template <typename T>
+void ring<T>::pop(void)
+{
+    _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
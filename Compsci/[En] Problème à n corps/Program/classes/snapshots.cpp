@@ -0,0 +1,210 @@
+//
+//  snapshots.cpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#include "snapshots.hpp"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+
+//  constructors
+
+snapshots::snapshots(const std::string path)
+{
+    int descriptor;
+    struct stat status;
+    void* data;
+
+    descriptor = open(path.c_str(), O_RDONLY);
+
+    if(descriptor < 0 || fstat(descriptor, &status) != 0 || (size_t) status.st_size < sizeof(snapshots_header))
+    {
+        cout << "Can't read the binary trajectory " << path << endl;
+        exit(1);
+    }
+
+    _length = (size_t) status.st_size;
+    data = mmap(nullptr, _length, PROT_READ, MAP_SHARED, descriptor, 0);
+    close(descriptor);  //  the mapping stays valid
+
+    if(data == MAP_FAILED)
+    {
+        cout << "Can't map the binary trajectory " << path << endl;
+        exit(1);
+    }
+
+    _data = (const char*) data;
+    _header = (const snapshots_header*) _data;
+
+    if(memcmp(_header->magic, "NBODYTRJ", 8) != 0 || _header->version != 1)
+    {
+        cout << path << " is not a binary trajectory" << endl;
+        exit(1);
+    }
+
+    //  the frames must begin after the masses and hold the time and 4 values per body
+    size_t masses_end = sizeof(snapshots_header) + (size_t) _header->bodies * (snapshots_name_size + sizeof(double));
+
+    if(_header->frame_size != (1 + 4 * (size_t) _header->bodies) * sizeof(double) || _header->frame_offset < masses_end || _header->frame_offset > _length)
+    {
+        cout << "The header of the binary trajectory " << path << " is damaged" << endl;
+        exit(1);
+    }
+
+    _size = (int) ((_length - _header->frame_offset) / _header->frame_size);
+
+    if(_size == 0)
+    {
+        cout << "The binary trajectory " << path << " is empty" << endl;
+        exit(1);
+    }
+}
+
+////////
+
+snapshots::~snapshots(void)
+{
+    munmap((void*) _data, _length);
+}
+
+//  getters
+
+int snapshots::size(void) const
+{
+    return (_size);
+}
+
+////////
+
+int snapshots::bodies(void) const
+{
+    return ((int) _header->bodies);
+}
+
+////////
+
+double snapshots::step(void) const
+{
+    return (_header->step);
+}
+
+////////
+
+double snapshots::years(void) const
+{
+    return (_header->years);
+}
+
+////////
+
+std::string snapshots::algorithm(void) const
+{
+    return (string(_header->algorithm, strnlen(_header->algorithm, sizeof(_header->algorithm))));
+}
+
+////////
+
+std::string snapshots::name(const int k) const
+{
+    const char* name = _data + sizeof(snapshots_header) + k * snapshots_name_size;
+
+    return (string(name, strnlen(name, snapshots_name_size)));
+}
+
+////////
+
+double snapshots::mass(const int k) const
+{
+    const double* masses = (const double*) (_data + sizeof(snapshots_header) + bodies() * snapshots_name_size);
+
+    return (masses[k]);
+}
+
+////////
+
+double snapshots::time(const int f) const
+{
+    return (_frame(f)[0]);
+}
+
+////////
+
+const double* snapshots::body(const int f, const int k) const
+{
+    if(k < 0 || k >= bodies())
+    {
+        cout << "There is no body " << k << " in the binary trajectory" << endl;
+        exit(1);
+    }
+
+    return (_frame(f) + 1 + 4 * k);
+}
+
+//  methods
+
+//  same layout as solver::_first_output and solver::_classic_output for Verlet
+//  and as solver::euler for Euler and the dense output, so the gnuplot scripts of the solver work with these files
+void snapshots::text(const std::string folder) const
+{
+    string space = "        ";
+    bool verlet = algorithm() == "Velocity-Verlet algorithm (2D)";
+
+    for(int k = 0; k < bodies(); k++)
+    {
+        ofstream output(folder + name(k));  //  erase the previous file
+        const double* first = body(0, k);
+        bool mass_center = first[0] * first[0] + first[1] * first[1] == 0.;
+
+        output << algorithm() << '\n';
+        output << name(k) << " (x, y, vx, vy)" << '\n';
+        output << "Timestep: " << years() << " years" << '\n' << '\n';
+
+        for(int f = 0; f < _size; f++)
+        {
+            const double* values = body(f, k);
+
+            //  Verlet writes the mass center once, at the beginning, and the other bodies from the second step
+            if(verlet && (mass_center != (f == 0)))
+            {
+                continue;
+            }
+
+            for(int i = 0; i < 4; i++)
+            {
+                output << setprecision(12) << values[i] << space;
+            }
+
+            if(!(verlet && mass_center))
+            {
+                output << '\n';
+            }
+        }
+    }
+}
+
+////////
+
+const double* snapshots::_frame(const int f) const
+{
+    if(f < 0 || f >= _size)
+    {
+        cout << "There is no frame " << f << " in the binary trajectory" << endl;
+        exit(1);
+    }
+
+    return ((const double*) (_data + _header->frame_offset + (size_t) f * _header->frame_size));
+}
@@ -0,0 +1,85 @@
+//
+//  snapshots.hpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#pragma once
+#include <string>
+#include <cstdint>
+
+
+//  binary trajectory file written by the solver in the binary output format
+//  (see solver::format and trajectory::open_binary), in the byte order of the machine
+//
+//  header              sizeof(snapshots_header) bytes
+//  names               bodies * 32 chars, completed with '\0'
+//  masses              bodies doubles, normalized like in the solver
+//  frames              frame_size bytes each, the frame f begins at frame_offset + f * frame_size
+//                      time, then (x, y, vx, vy) of each body
+//
+//  the number of frames is given by the size of the file, so a file cut by a crash is still readable
+//  a file without any frame, or whose header doesn't match this layout, is rejected
+
+struct snapshots_header
+{
+    char magic[8];  //  "NBODYTRJ"
+    std::uint32_t version;
+    std::uint32_t bodies;
+    double step;    //  time-step of the algorithm, in years
+    double years;   //  length of the run, in years
+    char algorithm[32]; //  first line of the text files, for the conversion
+    std::uint64_t frame_offset;
+    std::uint64_t frame_size;
+};
+
+static const int snapshots_name_size = 32;
+
+
+//  read-only view of a binary trajectory file mapped in memory
+//  any frame can be read without going through the previous ones
+
+class snapshots
+{
+
+public:
+
+    //  constructors
+
+    snapshots(const std::string path);
+    snapshots(const snapshots& other) = delete;
+    ~snapshots(void);
+
+    //  getters
+
+    int size(void) const;   //  number of frames
+    int bodies(void) const;
+    double step(void) const;
+    double years(void) const;
+    std::string algorithm(void) const;
+    std::string name(const int k) const;
+    double mass(const int k) const;
+    double time(const int f) const;
+    const double* body(const int f, const int k) const;    //  (x, y, vx, vy) of the body k in the frame f, which must exist
+
+    //  methods
+
+    void text(const std::string folder) const;  //  writes the usual text files, one per body, for gnuplot
+
+
+private:
+
+    //  data
+
+    const char* _data;
+    std::size_t _length;
+    const snapshots_header* _header;
+    int _size;
+
+    //  methods
+
+    const double* _frame(const int f) const;
+};
@@ -0,0 +1,338 @@
+//
+//  solver-adaptive.cpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#include "solver.hpp"
+#include "bodies.hpp"
+#include "parallel.hpp"
+#include <cmath>
+#include <string>
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+
+//  the algorithms whose time-steps follow the motion of the bodies
+
+
+//  Dormand-Prince 5(4): a Runge-Kutta method of order 5 with 7 stages, whose 4th order companion gives the error of each step
+//  the last stage is computed at the new positions, so it is the first stage of the next step: 6 force evaluations per step
+//  J. R. Dormand and P. J. Prince, A family of embedded Runge-Kutta formulae, J. Comp. Appl. Math. 6 (1980)
+
+static const double dp_a[7][6] =
+{
+    {0., 0., 0., 0., 0., 0.},
+    {1. / 5., 0., 0., 0., 0., 0.},
+    {3. / 40., 9. / 40., 0., 0., 0., 0.},
+    {44. / 45., -56. / 15., 32. / 9., 0., 0., 0.},
+    {19372. / 6561., -25360. / 2187., 64448. / 6561., -212. / 729., 0., 0.},
+    {9017. / 3168., -355. / 33., 46732. / 5247., 49. / 176., -5103. / 18656., 0.},
+    {35. / 384., 0., 500. / 1113., 125. / 192., -2187. / 6784., 11. / 84.}    //  the 5th order solution
+};
+
+//  difference between the 5th and the 4th order solutions
+static const double dp_error[7] = {71. / 57600., 0., -71. / 16695., 71. / 1920., -17253. / 339200., 22. / 525., -1. / 40.};
+
+
+void solver::dormand_prince(const double years, const std::string folder, const double tolerance)
+{
+    //  the tolerance is the error allowed at each step, relative to 1 + |x| for each coordinate
+    //  the steps get smaller where the accelerations change fast (perihelions, close encounters)
+    //  and larger elsewhere, the files contain one line per accepted step
+    
+    int n = _card;
+    int accepted = 0;
+    double start = _time;
+    double t = 0.;
+    double h = 1. / 365.;   //  first try, corrected at once if needed
+    bool last;
+    
+    _check_particles("dormand_prince");
+    _open_output(folder, "Dormand-Prince algorithm (2D)", years, h);
+    _start_writer(false, years);
+    _output_positions(0, start, false, years);
+    
+    //  after the first run, this doesn't allocate anything
+    _stages.resize(7 * 4 * n);
+    _system.save();
+    _dormand_prince_stage(0, 0.);
+    
+    while(t < years)
+    {
+        double error = 0.;
+        double* k = _stages.data();
+        
+        last = (t + h >= years);
+        
+        if(last)
+        {
+            h = years - t;
+        }
+        
+        for(int s = 1; s < 7; s++)
+        {
+            _dormand_prince_stage(s, h);
+        }
+        
+        //  the bodies are now at the 5th order solution
+        const double* before[4] = {_system.prev_x.data(), _system.prev_y.data(), _system.prev_vx.data(), _system.prev_vy.data()};
+        const double* after[4] = {_system.x.data(), _system.y.data(), _system.vx.data(), _system.vy.data()};
+        
+        for(int c = 0; c < 4; c++)
+        {
+            for(int i = 0; i < n; i++)
+            {
+                double difference = 0.;
+                double scale = tolerance * (1. + max(abs(before[c][i]), abs(after[c][i])));
+                
+                for(int j = 0; j < 7; j++)
+                {
+                    difference += dp_error[j] * k[4 * n * j + c * n + i];
+                }
+                
+                difference *= h / scale;
+                error += difference * difference;
+            }
+        }
+        
+        error = (n > 0) ? sqrt(error / (4 * n)) : 0.;
+        
+        if(error <= 1.)
+        {
+            t = last ? years : t + h;
+            accepted++;
+            
+            _time = start + t;
+            _system.time = _time;
+            _output_positions(accepted, _time, false, years);
+            _output_energies();
+            
+            _system.save();
+            swap_ranges(k + 6 * 4 * n, k + 7 * 4 * n, k);
+        }
+        
+        //  the error goes like h^5
+        h *= min(5., max(0.2, 0.9 * pow(error, -0.2)));
+        
+        if(h < 1.E-14 * years)
+        {
+            cout << "The time-step of Dormand-Prince is too small, the tolerance can't be reached." << endl;
+            exit(1);
+        }
+    }
+    
+    _stop_writer();
+    _output.close();
+    
+    //  the last stage was computed at the final positions: euler and verlet can go on from here
+    _system.prev_ax.swap(_system.next_ax);
+    _system.prev_ay.swap(_system.next_ay);
+    
+    _gnuplot(folder, years);
+    _gnuplot_png(folder, years);
+    _gnuplot_energies(folder, years);
+    _gnuplot_energies_png(folder, years);
+    
+    _time = start + years;
+}
+
+////////
+
+//  moves the bodies to prev_ + h * sum of dp_a[s][j] * k_j, and stores their derivatives in k_s
+//  k_s is (x', y', vx', vy') = (vx, vy, ax, ay) of each body, the mass center stays fixed
+void solver::_dormand_prince_stage(const int s, const double h)
+{
+    int n = _card;
+    double* k = _stages.data();
+    double* derivative = k + 4 * n * s;
+    
+    if(s > 0)
+    {
+        OMP(parallel for num_threads(_threads) schedule(static))
+        for(int i = 0; i < n; i++)
+        {
+            if(!_system.center(i))
+            {
+                double dx = 0., dy = 0., dvx = 0., dvy = 0.;
+                
+                for(int j = 0; j < s; j++)
+                {
+                    const double* stage = k + 4 * n * j;
+                    
+                    dx += dp_a[s][j] * stage[i];
+                    dy += dp_a[s][j] * stage[n + i];
+                    dvx += dp_a[s][j] * stage[2 * n + i];
+                    dvy += dp_a[s][j] * stage[3 * n + i];
+                }
+                
+                _system.x[i] = _system.prev_x[i] + h * dx;
+                _system.y[i] = _system.prev_y[i] + h * dy;
+                _system.vx[i] = _system.prev_vx[i] + h * dvx;
+                _system.vy[i] = _system.prev_vy[i] + h * dvy;
+            }
+        }
+    }
+    
+    _next_acceleration(false);
+    
+    for(int i = 0; i < n; i++)
+    {
+        bool fixed = _system.center(i);
+        
+        derivative[i] = fixed ? 0. : _system.vx[i];
+        derivative[n + i] = fixed ? 0. : _system.vy[i];
+        derivative[2 * n + i] = _system.next_ax[i];
+        derivative[3 * n + i] = _system.next_ay[i];
+    }
+}
+
+////////
+
+void solver::block_verlet(const double years, const std::string folder, const int steps, const double eta)
+{
+    //  velocity Verlet where each body has its own time-step h / 2^rung, chosen at each step h
+    //  the fast bodies (Mercury) are computed with small steps, the slow ones (Neptune) with the large step h
+    //  the files contain the positions at each step h, like Euler
+    
+    int timesteps;
+    double h;
+    double start = _time;
+    
+    timesteps = (int) (years * steps);
+    h = ((double) years) / ((double) timesteps);
+    
+    _check_particles("block_verlet");
+    _open_output(folder, "Block time-step Verlet algorithm (2D)", years, h);
+    _start_writer(false, years);
+    
+    //  the first kicks need the accelerations of all the bodies, then each step ends with all of them
+    _next_acceleration(false);
+    _rungs.assign(_card, 0);
+    
+    for(int i = 0; i <= timesteps; i++)
+    {
+        _output_positions(i, start + i * h, false, years);
+        
+        if(i < timesteps)
+        {
+            _block_step(h, eta);
+            
+            _time = start + (i + 1) * h;
+            _system.time = _time;
+            _output_energies();
+        }
+    }
+    
+    _stop_writer();
+    _output.close();
+    
+    //  euler and verlet can go on from here, see solver::_update_quantities
+    _system.save();
+    _system.prev_ax.swap(_system.next_ax);
+    _system.prev_ay.swap(_system.next_ay);
+    
+    _gnuplot(folder, years);
+    _gnuplot_png(folder, years);
+    _gnuplot_energies(folder, years);
+    _gnuplot_energies_png(folder, years);
+    
+    _time = start + years;
+}
+
+////////
+
+//  the step h is cut in 2^top ticks, where top is the largest rung
+//  at each tick all the bodies drift (the positions of the slow ones are predicted)
+//  but only the bodies whose step begins or ends are kicked, and only those whose step ends get a new acceleration
+//  kick(step/2) drift(step) kick(step/2) for each body, like in _verlet_positions and _verlet_velocities
+//  the step of a body is eta * sqrt(r / a), about eta / (2 pi) of its period on a circular orbit around the central body
+//  _system.next_ax and _system.next_ay must contain the accelerations of all the bodies at the beginning of the step
+void solver::_block_step(const double h, const double eta)
+{
+    static const int max_rung = 20;
+    int central = _central_body();
+    int top = 0;
+    int ticks;
+    double tick;
+    
+    for(int k = 0; k < _card; k++)
+    {
+        double r = sqrt(pow(_system.x[k] - _system.x[central], 2) + pow(_system.y[k] - _system.y[central], 2));
+        double a = sqrt(_system.next_ax[k] * _system.next_ax[k] + _system.next_ay[k] * _system.next_ay[k]);
+        
+        _rungs[k] = 0;
+        
+        if(k != central && a > 0.)
+        {
+            double dt = eta * sqrt(r / a);
+            
+            while(_rungs[k] < max_rung && h / (1 << _rungs[k]) > dt)
+            {
+                _rungs[k]++;
+            }
+        }
+        
+        top = max(top, _rungs[k]);
+    }
+    
+    //  the central body feels all the others, it follows the fastest one
+    if(!_system.center(central))
+    {
+        _rungs[central] = top;
+    }
+    
+    ticks = 1 << top;
+    tick = h / ticks;
+    
+    for(int t = 0; t < ticks; t++)
+    {
+        OMP(parallel for num_threads(_threads) schedule(static))
+        for(int k = 0; k < _card; k++)
+        {
+            if(!_system.center(k))
+            {
+                //  the step of the body begins
+                if(t % (1 << (top - _rungs[k])) == 0)
+                {
+                    double radical = 0.5 * h / (1 << _rungs[k]);
+                    
+                    _system.vx[k] += radical * _system.next_ax[k];
+                    _system.vy[k] += radical * _system.next_ay[k];
+                }
+                
+                _system.x[k] += tick * _system.vx[k];
+                _system.y[k] += tick * _system.vy[k];
+            }
+        }
+        
+        _active.clear();
+        
+        for(int k = 0; k < _card; k++)
+        {
+            if((t + 1) % (1 << (top - _rungs[k])) == 0)
+            {
+                _active.push_back(k);
+            }
+        }
+        
+        _partial_acceleration(_active);
+        
+        //  the step of the active bodies ends
+        for(int k : _active)
+        {
+            if(!_system.center(k))
+            {
+                double radical = 0.5 * h / (1 << _rungs[k]);
+                
+                _system.vx[k] += radical * _system.next_ax[k];
+                _system.vy[k] += radical * _system.next_ay[k];
+            }
+        }
+    }
+}
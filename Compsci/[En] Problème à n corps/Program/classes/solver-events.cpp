@@ -0,0 +1,273 @@
+//
+//  solver-events.cpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#include "solver.hpp"
+#include "bodies.hpp"
+#include <cmath>
+#include <string>
+#include <fstream>
+#include <iomanip>
+
+using namespace std;
+
+
+//  what happens between two time-steps of euler and verlet
+//  all use the cubic Hermite interpolation of the positions and the velocities at both ends of the step
+
+
+//  the interpolations begin from the state at ti kept by solver::_save_step, not from the prev_ vectors
+//  the compositions of Yoshida overwrite those at each substep, see solver::_verlet_step
+
+
+void solver::_save_step(void)
+{
+    if(_dense_interval > 0. || _ephemeris_record < _ephemeris_records || !_perihelion_bodies.empty())
+    {
+        _step_start.copy_state(_system);
+    }
+}
+
+
+//  perihelions, see solver::perihelions
+//  the distance r to the central body is minimal when r.v = (1/2) d(r^2)/dt goes from negative to positive
+//  so each step only costs two dot products per watched body, without any square root
+//  the step which brackets a perihelion is then refined on the interpolation: the time and the angle
+//  don't depend on the step falling close to the perihelion
+
+
+//  cubic Hermite interpolation of one coordinate between ti (s = 0) and ti + h (s = 1)
+static inline void interpolate(const double s, const double h, const double p0, const double v0, const double p1, const double v1, double& p, double& v)
+{
+    double s2 = s * s;
+    double s3 = s2 * s;
+
+    p = (2. * s3 - 3. * s2 + 1.) * p0 + (s3 - 2. * s2 + s) * h * v0 + (3. * s2 - 2. * s3) * p1 + (s3 - s2) * h * v1;
+    v = (6. * s2 - 6. * s) * (p0 - p1) / h + (3. * s2 - 4. * s + 1.) * v0 + (3. * s2 - 2. * s) * v1;
+}
+
+////////
+
+void solver::_open_perihelions(const double h)
+{
+    _perihelion_bodies.clear();
+    _perihelion_files.clear();
+    _perihelion_center = _central_body();
+
+    for(auto& name : _perihelion_names)
+    {
+        for(int k = 0; k < _card; k++)
+        {
+            if(_system.name[k] == name && k != _perihelion_center)
+            {
+                //  the names of the files are built once, not at each perihelion
+                _perihelion_bodies.push_back(k);
+                _perihelion_files.push_back(name + " perihelions");
+
+                ofstream& output = _output.file(_perihelion_files.back());
+                output << "Perihelions of " << name << " around " << _system.name[_perihelion_center] << " (t, xp, yp, thetap)" << '\n';
+                output << "Timestep: " << h << " years, thetap in arcseconds" << '\n' << '\n';
+                output << setprecision(15);
+            }
+        }
+    }
+}
+
+////////
+
+//  the step goes from the values kept by solver::_save_step at start to the current ones at start + h
+void solver::_detect_perihelions(const double start, const double h)
+{
+    int c = _perihelion_center;
+
+    for(size_t n = 0; n < _perihelion_bodies.size(); n++)
+    {
+        int k = _perihelion_bodies[n];
+        double x0 = _step_start.x[k] - _step_start.x[c];
+        double y0 = _step_start.y[k] - _step_start.y[c];
+        double vx0 = _step_start.vx[k] - _step_start.vx[c];
+        double vy0 = _step_start.vy[k] - _step_start.vy[c];
+        double x1 = _system.x[k] - _system.x[c];
+        double y1 = _system.y[k] - _system.y[c];
+        double vx1 = _system.vx[k] - _system.vx[c];
+        double vy1 = _system.vy[k] - _system.vy[c];
+
+        if(x0 * vx0 + y0 * vy0 >= 0. || x1 * vx1 + y1 * vy1 < 0.)
+        {
+            continue;
+        }
+
+        //  bisection on r.v, down to the rounding errors of the time
+        double low = 0.;
+        double high = 1.;
+        double s, x, y, vx, vy;
+
+        for(int iteration = 0; iteration < 50; iteration++)
+        {
+            s = 0.5 * (low + high);
+            interpolate(s, h, x0, vx0, x1, vx1, x, vx);
+            interpolate(s, h, y0, vy0, y1, vy1, y, vy);
+
+            if(x * vx + y * vy < 0.)
+            {
+                low = s;
+            }
+            else
+            {
+                high = s;
+            }
+        }
+
+        s = 0.5 * (low + high);
+        interpolate(s, h, x0, vx0, x1, vx1, x, vx);
+        interpolate(s, h, y0, vy0, y1, vy1, y, vy);
+
+        ofstream& output = _output.file(_perihelion_files[n]);
+        output << start + s * h << "        " << x << "        " << y << "        " << 648000. * atan2(y, x) / M_PI << '\n';
+    }
+}
+
+
+//  dense output, see solver::dense
+//  the files are written at the times start + n * interval of a grid chosen by the user, not at the steps
+//  large steps still give smooth curves, and small ones only write what is needed
+//  the columns are the ones of euler, for every body; the energies are still written at the steps
+
+
+void solver::_start_dense(const double years)
+{
+    if(_dense_interval == 0.)
+    {
+        return;
+    }
+
+    _dense_next = 0;
+    _dense_last = (int) floor(years / _dense_interval + 1.E-9);
+    _dense.copy_state(_system);
+}
+
+////////
+
+void solver::_dense_output(const double start, const double ti, const double h, const double years)
+{
+    while(_dense_interval > 0. && _dense_next <= _dense_last)
+    {
+        double t = start + _dense_next * _dense_interval;
+        double s = (t - ti) / h;
+
+        if(s >= 1.)
+        {
+            return;
+        }
+
+        for(int k = 0; k < _card; k++)
+        {
+            interpolate(s, h, _step_start.x[k], _step_start.vx[k], _system.x[k], _system.vx[k], _dense.x[k], _dense.vx[k]);
+            interpolate(s, h, _step_start.y[k], _step_start.vy[k], _system.y[k], _system.vy[k], _dense.y[k], _dense.vy[k]);
+        }
+
+        _dense.time = t;
+        _output_positions(_dense, _dense_next, t, false, years);
+        _dense_next++;
+    }
+}
+
+
+//  ephemeris, see solver::chebyshev and ephemeris.hpp
+//  each span is sampled at the n Chebyshev nodes, x_j = cos(pi (j + 1/2) / n) in [-1, 1], as the run goes through them
+//  once the last node is reached, the coefficients are given by the discrete cosine transform of the samples
+//  c_i = (2 / n) sum_j f(x_j) cos(pi i (j + 1/2) / n), with half of it for c_0, and written right away
+//  only the spans which end before the end of the run are written
+
+
+void solver::_open_ephemeris(const std::string folder, const double start, const double years)
+{
+    int n = _ephemeris_size;
+
+    _ephemeris_records = 0;
+
+    if(_ephemeris_span == 0.)
+    {
+        return;
+    }
+
+    _ephemeris_records = (int) floor(years / _ephemeris_span + 1.E-9);
+    _ephemeris_record = 0;
+    _ephemeris_node = 0;
+    _ephemeris_nodes.resize(n);
+    _ephemeris_cosines.resize(n * n);
+    _ephemeris_samples.resize(2 * _card * n);
+    _ephemeris_coefficients.resize(2 * _card * n);
+
+    for(int j = 0; j < n; j++)
+    {
+        //  x_j decreases with j, so the node j is the (n - 1 - j)-th in time
+        _ephemeris_nodes[n - 1 - j] = 0.5 * _ephemeris_span * (1. + cos(M_PI * (j + 0.5) / n));
+
+        for(int i = 0; i < n; i++)
+        {
+            _ephemeris_cosines[i * n + j] = cos(M_PI * i * (j + 0.5) / n);
+        }
+    }
+
+    _output.open_ephemeris(folder, _system, start, _ephemeris_span, n);
+}
+
+////////
+
+void solver::_ephemeris_output(const double start, const double ti, const double h)
+{
+    int n = _ephemeris_size;
+    double velocity;
+
+    while(_ephemeris_record < _ephemeris_records)
+    {
+        double t = start + _ephemeris_record * _ephemeris_span + _ephemeris_nodes[_ephemeris_node];
+        double s = (t - ti) / h;
+        int j = n - 1 - _ephemeris_node;
+
+        if(s >= 1.)
+        {
+            return;
+        }
+
+        for(int k = 0; k < _card; k++)
+        {
+            interpolate(s, h, _step_start.x[k], _step_start.vx[k], _system.x[k], _system.vx[k], _ephemeris_samples[2 * n * k + j], velocity);
+            interpolate(s, h, _step_start.y[k], _step_start.vy[k], _system.y[k], _system.vy[k], _ephemeris_samples[2 * n * k + n + j], velocity);
+        }
+
+        _ephemeris_node++;
+
+        if(_ephemeris_node < n)
+        {
+            continue;
+        }
+
+        for(int c = 0; c < 2 * _card; c++)
+        {
+            const double* samples = &_ephemeris_samples[c * n];
+
+            for(int i = 0; i < n; i++)
+            {
+                double sum = 0.;
+
+                for(int j = 0; j < n; j++)
+                {
+                    sum += samples[j] * _ephemeris_cosines[i * n + j];
+                }
+
+                _ephemeris_coefficients[c * n + i] = ((i == 0) ? 1. : 2.) * sum / n;
+            }
+        }
+
+        _output.record(_ephemeris_coefficients);
+        _ephemeris_node = 0;
+        _ephemeris_record++;
+    }
+}
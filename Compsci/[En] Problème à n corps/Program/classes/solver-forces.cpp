@@ -0,0 +1,495 @@
+//
+//  solver-forces.cpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#include "solver.hpp"
+#include "bodies.hpp"
+#include "tree.hpp"
+#include "kernels.hpp"
+#include "parallel.hpp"
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+
+
+//  all the ways to compute the accelerations of the bodies
+//  _acceleration is the reference, the other engines are compared to it in the unit tests
+
+
+//  force laws of the direct and the pairwise sums, chosen once per force pass instead of being tested for each pair
+//  the correction multiplies the force of each pair, its momentum is the one of the body it is applied to
+
+
+struct newtonian
+{
+    static inline double correction(const double, const double)
+    {
+        return (1.);
+    }
+};
+
+//  first post-Newtonian correction for a body around a fixed mass: 1 + 3 l^2 / (r^2 c^2)
+//  with l = x vy - y vx its angular momentum per unit mass, c in AU/year
+struct post_newtonian
+{
+    static inline double correction(const double momentum, const double r_squared)
+    {
+        double const c = 63241.0770;
+        
+        return (1. + (3. * momentum * momentum) / (r_squared * c * c));
+    }
+};
+
+////////
+
+//  only one method for a relativistic or non-relativistic simulation
+void solver::_acceleration(const int p, const bool relativity, double& ax, double& ay) const
+{
+    if(relativity)
+    {
+        _acceleration<post_newtonian>(p, ax, ay);
+    }
+    else
+    {
+        _acceleration<newtonian>(p, ax, ay);
+    }
+}
+
+////////
+
+template <class law>
+void solver::_acceleration(const int p, double& ax, double& ay) const
+{
+    //  p is the index of the planet for which we calculate eta
+    
+    double const g_const = 4 * M_PI * M_PI;
+    double radical; //  just a variable to avoid calculations
+    double r;
+    double relative_x;
+    double relative_y;
+    const double* x = _system.x.data();
+    const double* y = _system.y.data();
+    const double* m = _system.m.data();
+    double momentum = x[p] * _system.vy[p] - y[p] * _system.vx[p];
+    
+    ax = 0.;
+    ay = 0.;
+    
+    if(!_system.center(p))  // the mass center must remain fixed
+    {
+        for(int k = 0; k < _card; k++)
+        {
+            if(k != p)
+            {
+                relative_x = x[p] - x[k];  //  x - xk
+                relative_y = y[p] - y[k];
+                
+                r = sqrt(relative_x * relative_x + relative_y * relative_y);
+                double r_squared = r * r;
+                double r_cubed = r_squared * r;
+                double correction = law::correction(momentum, r_squared);
+                radical = m[k] / r_cubed;
+                
+                //  the correction multiplies the sum so far, as in the first version of this method
+                ax -= radical * relative_x;
+                ay -= radical * relative_y;
+                ax *= correction;
+                ay *= correction;
+            }
+        }
+        ax *= g_const ;
+        ay *= g_const;
+    }
+    //  this concerns especially the sun when it is center of mass
+    //  this assures that it remains fix if the initial velocity is (0, 0)
+}
+
+////////
+
+//  it is just used in verlet to compute a(t+dt) when we want v(t)
+//  and in euler to compute a(t)
+//  each target body is computed independently, so the results don't depend on the number of threads
+void solver::_next_acceleration(const bool relativity)
+{
+    const double* x = _system.x.data();
+    const double* y = _system.y.data();
+    const double* m = _system.m.data();
+    double* ax = _system.next_ax.data();
+    double* ay = _system.next_ay.data();
+    
+    _potential_ready = false;
+    _evaluations++;
+    
+    if(relativity && _method == barnes_hut)
+    {
+        cout << "The relativistic correction is not available with the Barnes-Hut tree." << endl;
+        exit(1);
+    }
+    if(relativity && _method == simd)
+    {
+        cout << "The relativistic correction is not available with the vectorized sum." << endl;
+        exit(1);
+    }
+    
+    if(_method == pairwise)
+    {
+        _pairwise_acceleration(relativity);
+        return;
+    }
+    
+    if(_method == barnes_hut)
+    {
+        _tree.build(_system);
+    }
+    
+    //  the cost of a body is not the same for all of them with the tree
+    //  so the bodies are given to the threads by small packets
+    OMP(parallel for num_threads(_threads) schedule(dynamic, 16))
+    for(int k = 0; k < _card; k++)
+    {
+        _body_acceleration(k, relativity, x, y, m, ax, ay);
+    }
+}
+
+////////
+
+//  only the bodies of active get a new acceleration, with the positions of all the bodies
+//  the pairwise engine can't compute a few bodies, they are computed like with the direct sum
+void solver::_partial_acceleration(const std::vector<int>& active)
+{
+    const double* x = _system.x.data();
+    const double* y = _system.y.data();
+    const double* m = _system.m.data();
+    double* ax = _system.next_ax.data();
+    double* ay = _system.next_ay.data();
+    int size = (int) active.size();
+    
+    _potential_ready = false;
+    _evaluations++;
+    
+    if(_method == barnes_hut)
+    {
+        _tree.build(_system);
+    }
+    
+    OMP(parallel for num_threads(_threads) schedule(dynamic, 16))
+    for(int i = 0; i < size; i++)
+    {
+        _body_acceleration(active[i], false, x, y, m, ax, ay);
+    }
+}
+
+////////
+
+//  Newton's third law: the force of k on p is the opposite of the force of p on k
+//  so we visit each pair (p, k) once, with one square root, and update both bodies
+//  the results are the ones of _acceleration up to the rounding errors (the sums are not done in the same order)
+//  with several threads, each thread sums its pairs in its own part of _buffer
+//  and the parts are added in the same order at the end: same number of threads, same results
+//  with relativity, the correction of each pair is computed with the momentum of the body it is applied to
+//  for a two-body system like Mercury-Sun this gives exactly the results of _acceleration
+//  with the fused energies, the potential energy of each pair is summed in the same sweep
+//  with the convention of solver::potential_energy, where each pair is counted twice
+void solver::_pairwise_acceleration(const bool relativity)
+{
+    if(relativity)
+    {
+        _pairwise_acceleration<post_newtonian>();
+    }
+    else
+    {
+        _pairwise_acceleration<newtonian>();
+    }
+}
+
+template <class law>
+void solver::_pairwise_acceleration(void)
+{
+    double const g_const = 4 * M_PI * M_PI;
+    const double* x = _system.x.data();
+    const double* y = _system.y.data();
+    const double* vx = _system.vx.data();
+    const double* vy = _system.vy.data();
+    const double* m = _system.m.data();
+    double* ax = _system.next_ax.data();
+    double* ay = _system.next_ay.data();
+    bool potential = (_energy == fused);
+    
+    //  after the first step, this doesn't allocate anything
+    _buffer.assign(2 * _threads * _card, 0.);
+    _thread_potential.assign(_threads, 0.);
+    
+    OMP(parallel num_threads(_threads))
+    {
+        double* buffer_x = _buffer.data() + 2 * _thread_number() * _card;
+        double* buffer_y = buffer_x + _card;
+        double thread_potential = 0.;
+        double relative_x, relative_y;
+        double r, r_squared, r_cubed;
+        double radical_p, radical_k;
+        
+        //  the first bodies have more pairs, one by one they are shared evenly
+        OMP(for schedule(static, 1))
+        for(int p = 0; p < _card; p++)
+        {
+            double momentum_p = x[p] * vy[p] - y[p] * vx[p];
+            double ax_p = 0.;
+            double ay_p = 0.;
+            double potential_p = 0.;
+            
+            for(int k = p + 1; k < _card; k++)
+            {
+                relative_x = x[p] - x[k];  //  x - xk
+                relative_y = y[p] - y[k];
+                
+                r = sqrt(relative_x * relative_x + relative_y * relative_y);
+                r_squared = r * r;
+                r_cubed = r_squared * r;
+                radical_p = m[k] / r_cubed;
+                radical_k = m[p] / r_cubed;
+                
+                if(potential)
+                {
+                    potential_p += m[k] / r_squared;
+                }
+                
+                double momentum_k = x[k] * vy[k] - y[k] * vx[k];
+                double correction_p = law::correction(momentum_p, r_squared);
+                double correction_k = law::correction(momentum_k, r_squared);
+                
+                //  a Newtonian correction is 1, the products disappear at compilation
+                ax_p -= (radical_p * relative_x) * correction_p;
+                ay_p -= (radical_p * relative_y) * correction_p;
+                buffer_x[k] += (radical_k * relative_x) * correction_k;
+                buffer_y[k] += (radical_k * relative_y) * correction_k;
+            }
+            
+            buffer_x[p] += ax_p;
+            buffer_y[p] += ay_p;
+            thread_potential += m[p] * potential_p;
+        }
+        
+        _thread_potential[_thread_number()] = thread_potential;
+    }
+    
+    if(potential)
+    {
+        _potential = 0.;
+        
+        for(int t = 0; t < _threads; t++)
+        {
+            _potential += _thread_potential[t];
+        }
+        
+        _potential *= -2. * g_const;
+        _potential_ready = true;
+    }
+    
+    OMP(parallel for num_threads(_threads) schedule(static))
+    for(int k = 0; k < _card; k++)
+    {
+        ax[k] = _buffer[k];
+        ay[k] = _buffer[_card + k];
+        
+        for(int t = 1; t < _threads; t++)
+        {
+            ax[k] += _buffer[2 * t * _card + k];
+            ay[k] += _buffer[2 * t * _card + _card + k];
+        }
+        
+        //  the mass center must remain fixed, see solver::_acceleration
+        if(_system.center(k))
+        {
+            ax[k] = 0.;
+            ay[k] = 0.;
+        }
+        else
+        {
+            ax[k] *= g_const;
+            ay[k] *= g_const;
+        }
+    }
+}
+
+////////
+
+//  the jerk is the derivative of the acceleration: for the pair (p, k), with r = xp - xk and v = vp - vk
+//  jp = - G mk [v / r^3 - 3 (r.v) r / r^5], and the opposite for k with mp
+//  each pair is visited once, with the buffers of the threads like in _pairwise_acceleration
+//  the acceleration and the jerk of the mass center are 0, see solver::_acceleration
+void solver::_hermite_acceleration(void)
+{
+    double const g_const = 4 * M_PI * M_PI;
+    const double* x = _system.x.data();
+    const double* y = _system.y.data();
+    const double* vx = _system.vx.data();
+    const double* vy = _system.vy.data();
+    const double* m = _system.m.data();
+    double* ax = _system.next_ax.data();
+    double* ay = _system.next_ay.data();
+    double* jx = _jerks.data() + 2 * _card;
+    double* jy = jx + _card;
+    
+    _potential_ready = false;
+    _evaluations++;
+    
+    //  after the first step, this doesn't allocate anything
+    _buffer.assign(4 * _threads * _card, 0.);
+    
+    OMP(parallel num_threads(_threads))
+    {
+        double* buffer_ax = _buffer.data() + 4 * _thread_number() * _card;
+        double* buffer_ay = buffer_ax + _card;
+        double* buffer_jx = buffer_ay + _card;
+        double* buffer_jy = buffer_jx + _card;
+        
+        OMP(for schedule(static, 1))
+        for(int p = 0; p < _card; p++)
+        {
+            double ax_p = 0., ay_p = 0., jx_p = 0., jy_p = 0.;
+            
+            for(int k = p + 1; k < _card; k++)
+            {
+                double relative_x = x[p] - x[k];
+                double relative_y = y[p] - y[k];
+                double relative_vx = vx[p] - vx[k];
+                double relative_vy = vy[p] - vy[k];
+                double r_squared = relative_x * relative_x + relative_y * relative_y;
+                double r = sqrt(r_squared);
+                double inverse_r3 = 1. / (r_squared * r);
+                double rv = 3. * (relative_x * relative_vx + relative_y * relative_vy) / r_squared;
+                double jerk_x = (relative_vx - rv * relative_x) * inverse_r3;
+                double jerk_y = (relative_vy - rv * relative_y) * inverse_r3;
+                
+                ax_p -= m[k] * relative_x * inverse_r3;
+                ay_p -= m[k] * relative_y * inverse_r3;
+                jx_p -= m[k] * jerk_x;
+                jy_p -= m[k] * jerk_y;
+                buffer_ax[k] += m[p] * relative_x * inverse_r3;
+                buffer_ay[k] += m[p] * relative_y * inverse_r3;
+                buffer_jx[k] += m[p] * jerk_x;
+                buffer_jy[k] += m[p] * jerk_y;
+            }
+            
+            buffer_ax[p] += ax_p;
+            buffer_ay[p] += ay_p;
+            buffer_jx[p] += jx_p;
+            buffer_jy[p] += jy_p;
+        }
+    }
+    
+    OMP(parallel for num_threads(_threads) schedule(static))
+    for(int k = 0; k < _card; k++)
+    {
+        double sum[4] = {0., 0., 0., 0.};
+        
+        for(int t = 0; t < _threads; t++)
+        {
+            for(int c = 0; c < 4; c++)
+            {
+                sum[c] += _buffer[(4 * t + c) * _card + k];
+            }
+        }
+        
+        bool fixed = _system.center(k);
+        
+        ax[k] = fixed ? 0. : g_const * sum[0];
+        ay[k] = fixed ? 0. : g_const * sum[1];
+        jx[k] = fixed ? 0. : g_const * sum[2];
+        jy[k] = fixed ? 0. : g_const * sum[3];
+    }
+}
+
+////////
+
+//  the test particles are given to the threads by batches small enough to stay in the cache
+//  the planets don't depend on them, so the cost is O(planets x particles) instead of O((planets + particles)^2)
+void solver::_particle_acceleration(void)
+{
+    const int batch = 256;
+    int n = _particles.size();
+    double* ax = _particles.next_ax.data();
+    double* ay = _particles.next_ay.data();
+    
+    if(n == 0)
+    {
+        return;
+    }
+    
+    OMP(parallel for num_threads(_threads) schedule(dynamic))
+    for(int begin = 0; begin < n; begin += batch)
+    {
+        _particle_acceleration(begin, min(begin + batch, n), ax, ay);
+    }
+}
+
+////////
+
+//  the planets are the outer loop, so the inner loop goes through contiguous particles and can be vectorized
+//  a particle at the position of a planet isn't attracted by it, a particle at the origin remains fixed like the mass center
+void solver::_particle_acceleration(const int begin, const int end, double* ax, double* ay) const
+{
+    double const g_const = 4 * M_PI * M_PI;
+    const double* x = _particles.x.data();
+    const double* y = _particles.y.data();
+    
+    for(int p = begin; p < end; p++)
+    {
+        ax[p] = 0.;
+        ay[p] = 0.;
+    }
+    
+    for(int k = 0; k < _card; k++)
+    {
+        double xk = _system.x[k];
+        double yk = _system.y[k];
+        double mk = _system.m[k];
+        
+        for(int p = begin; p < end; p++)
+        {
+            double relative_x = x[p] - xk;
+            double relative_y = y[p] - yk;
+            double r_squared = relative_x * relative_x + relative_y * relative_y;
+            double r = sqrt(r_squared);
+            double radical = (r_squared > 0.) ? mk / (r_squared * r) : 0.;
+            
+            ax[p] -= radical * relative_x;
+            ay[p] -= radical * relative_y;
+        }
+    }
+    
+    for(int p = begin; p < end; p++)
+    {
+        if(_particles.center(p))
+        {
+            ax[p] = 0.;
+            ay[p] = 0.;
+        }
+        else
+        {
+            ax[p] *= g_const;
+            ay[p] *= g_const;
+        }
+    }
+}
+
+////////
+
+int solver::_thread_number(void)
+{
+#ifdef _OPENMP
+    return (omp_get_thread_num());
+#else
+    return (0);
+#endif
+}
@@ -0,0 +1,280 @@
+//
+//  solver-output.cpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#include "solver.hpp"
+#include "bodies.hpp"
+#include "ring.hpp"
+#include "trajectory.hpp"
+#include "checkpoint.hpp"
+#include <string>
+#include <fstream>
+#include <thread>
+#include <chrono>
+
+using namespace std;
+
+
+//  the files written by euler and verlet at each time-step
+//  without an output thread, they are written in the run, as before
+//  with an output thread (see solver::asynchronous), the run copies the positions and the energies in a frame
+//  of a queue allocated once, and a second thread formats and writes them in the same order
+//  the run only waits when the queue is full, the output thread when it is empty
+//  nothing is allocated after the first step: the names of the files below are built once, not at each step
+
+
+static const string kinetic_energy_file = "system-kinetic-energy";
+static const string potential_energy_file = "system-potential-energy";
+static const string total_energy_file = "system-total-energy";
+
+
+void solver::_output_positions(const int i, const double time, const bool verlet, const double years)
+{
+    _output_positions(_system, i, time, verlet, years);
+}
+
+void solver::_output_positions(const bodies& state, const int i, const double time, const bool verlet, const double years)
+{
+    if(_capacity == 0)
+    {
+        _write_positions(state, i, time, verlet, years);
+        return;
+    }
+
+    frame* next = _reserve_frame();
+
+    next->step = i;
+    next->positions = true;
+    next->energies = false;
+    next->time = time;
+    next->state.copy_state(state);
+    _frames->publish();
+}
+
+////////
+
+//  the energies are computed here in both cases, the output thread only writes them
+//  the positions haven't changed since the last force pass, so its potential energy can be used
+void solver::_output_energies(void)
+{
+    double kinetic = kinetic_energy();
+    double potential = _potential_ready ? _potential : potential_energy();
+    double total = kinetic + potential;
+
+    if(_capacity == 0)
+    {
+        _print_energy(kinetic_energy_file, _time, kinetic);
+        _print_energy(potential_energy_file, _time, potential);
+        _print_energy(total_energy_file, _time, total);
+        return;
+    }
+
+    frame* next = _reserve_frame();
+
+    next->positions = false;
+    next->energies = true;
+    next->clock = _time;
+    next->kinetic = kinetic;
+    next->potential = potential;
+    next->total = total;
+    _frames->publish();
+}
+
+////////
+
+//  waits while the queue is full
+solver::frame* solver::_reserve_frame(void)
+{
+    frame* next;
+    bool stalled = false;
+
+    while((next = _frames->reserve()) == nullptr)
+    {
+        stalled = true;
+        this_thread::yield();
+    }
+
+    if(stalled)
+    {
+        _stalls++;
+    }
+
+    return (next);
+}
+
+////////
+
+//  Verlet writes the mass center once, at the first step, and the other bodies from the second step
+//  the other algorithms write every body at every step
+void solver::_write_positions(const bodies& state, const int i, const double time, const bool verlet, const double years)
+{
+    if(_format == binary)
+    {
+        _output.snapshot(time, state);
+        return;
+    }
+
+    for(int k = 0; k < _card; k++)
+    {
+        if(verlet)
+        {
+            _first_output(state, k, i, years);
+
+            if(!state.center(k))
+            {
+                _classic_output(state, k, i);
+            }
+        }
+        else
+        {
+            ofstream& output = _output.body(k);
+
+            if(i == 0)
+            {
+                //  only write the header once
+                output << _algorithm << '\n';
+                output << _system.name[k] << " (x, y, vx, vy)" << '\n';
+                output << "Timestep: " << years << " years" << '\n' << '\n';
+            }
+
+            state.print_pos(k, output);   //  prints quantities for a gnuplot
+            state.print_vel(k, output);
+            output << '\n';
+        }
+    }
+}
+
+////////
+
+void solver::_start_writer(const bool verlet, const double years)
+{
+    _stalls = 0;
+
+    if(_capacity == 0)
+    {
+        return;
+    }
+
+    //  the queue is kept from a run to the next one, it is empty at the end of a run
+    if(!_frames || _frames->capacity() < _capacity)
+    {
+        _frames.reset(new ring<frame>(_capacity));
+    }
+
+    _running = true;
+    _writer = thread(&solver::_write_frames, this, verlet, years);
+}
+
+////////
+
+void solver::_write_frames(const bool verlet, const double years)
+{
+    frame* next;
+    bool running;
+
+    while(true)
+    {
+        //  read before the queue: once the run is over, every frame is already in it
+        running = _running.load();
+        next = _frames->front();
+
+        if(next != nullptr)
+        {
+            if(next->positions)
+            {
+                _write_positions(next->state, next->step, next->time, verlet, years);
+            }
+
+            if(next->energies)
+            {
+                _print_energy(kinetic_energy_file, next->clock, next->kinetic);
+                _print_energy(potential_energy_file, next->clock, next->potential);
+                _print_energy(total_energy_file, next->clock, next->total);
+            }
+
+            _frames->pop();
+        }
+        else if(!running)
+        {
+            break;
+        }
+        else
+        {
+            this_thread::sleep_for(chrono::microseconds(50));
+        }
+    }
+}
+
+////////
+
+void solver::_stop_writer(void)
+{
+    if(_writer.joinable())
+    {
+        _running = false;
+        _writer.join();
+    }
+}
+
+////////
+
+//  waits until the output thread has written every frame of the queue, the run doesn't publish any meanwhile
+void solver::_drain_writer(void)
+{
+    while(_writer.joinable() && !_frames->empty())
+    {
+        this_thread::sleep_for(chrono::microseconds(50));
+    }
+}
+
+
+//  periodic checkpoints, see solver::checkpoints
+//  the run copies the state (no allocation once the copies have the right sizes), then a thread writes the copy
+//  while the next steps are computed; the run only waits if the previous checkpoint isn't written yet
+
+
+checkpoint_header solver::_checkpoint_header(const double time) const
+{
+    checkpoint_header header = {};
+    
+    header.time = time;
+    header.total_mass = _total_mass;
+    header.mass_center[0] = _mass_center[0];
+    header.mass_center[1] = _mass_center[1];
+    
+    return (header);
+}
+
+////////
+
+void solver::_periodic_checkpoint(const int i, const double time)
+{
+    if(_checkpoint_steps == 0 || (i + 1) % _checkpoint_steps != 0)
+    {
+        return;
+    }
+    
+    //  the files hold every step before the checkpoint, so a run restarted from it doesn't lose any line
+    _drain_writer();
+    _output.flush();
+    
+    _wait_checkpoint();
+    _checkpoint_system = _system;
+    _checkpoint_particles = _particles;
+    _checkpointer = thread(write_checkpoint, _checkpoint_path, _checkpoint_header(time), cref(_checkpoint_system), cref(_checkpoint_particles));
+}
+
+////////
+
+void solver::_wait_checkpoint(void)
+{
+    if(_checkpointer.joinable())
+    {
+        _checkpointer.join();
+    }
+}
@@ -10,12 +10,16 @@
 
 #include "solver.hpp"
 #include "planet.hpp"
+#include "kepler.hpp"
+#include "loader.hpp"
+#include "parallel.hpp"
 #include <cmath>
 #include <string>
 #include <fstream>
 #include <vector>
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 
 using namespace std;
 
@@ -28,6 +32,29 @@ solver::solver(void)
     _card = 0;
     _time = 0;
     _total_mass = 0.;
+    _method = direct;
+    _threads = 1;
+    _format = text;
+    _energy = separate;
+    _scheme = verlet2;
+    _steps = 0;
+    _evaluations = 0;
+    _pending = false;
+    _potential = 0.;
+    _potential_ready = false;
+    _capacity = 0;
+    _stalls = 0;
+    _running = false;
+    _checkpoint_steps = 0;
+    _dense_interval = 0.;
+    _dense_next = 0;
+    _dense_last = 0;
+    _ephemeris_span = 0.;
+    _ephemeris_size = 0;
+    _ephemeris_records = 0;
+    _ephemeris_record = 0;
+    _ephemeris_node = 0;
+    _perihelion_center = 0;
     _mass_center = {0., 0.};
     
 }
@@ -36,17 +63,53 @@ solver::solver(void)
 
 solver::solver(const solver& other)
 {
+    *this = other;
+}
+
+////////
+
+solver& solver::operator=(const solver& other)
+{
+    if(this == &other)
+    {
+        return (*this);
+    }
+    
+    _wait_checkpoint();
     
     _card = other._card;
     _time = other._time;
     _total_mass = other._total_mass;
+    _method = other._method;
+    _tree = tree(other._tree.theta());
+    _threads = other._threads;
+    _format = other._format;
+    _energy = other._energy;
+    _scheme = other._scheme;
+    _steps = other._steps;
+    _evaluations = 0;
+    _pending = other._pending;
+    _potential = 0.;
+    _potential_ready = false;
+    _capacity = other._capacity;
+    _stalls = 0;
+    _running = false;
+    _checkpoint_steps = 0;  //  two solvers must not write the same file
+    _dense_interval = other._dense_interval;
+    _dense_next = 0;
+    _dense_last = 0;
+    _ephemeris_span = other._ephemeris_span;
+    _ephemeris_size = other._ephemeris_size;
+    _ephemeris_records = 0;
+    _ephemeris_record = 0;
+    _ephemeris_node = 0;
+    _perihelion_names = other._perihelion_names;
+    _perihelion_center = 0;
     _mass_center = other._mass_center;
     _system = other._system;
+    _particles = other._particles;
     
-    _prev_pos = other._prev_pos;
-    _prev_vel = other._prev_vel;
-    _prev_acc = other._prev_acc;
-    _next_acc = other._prev_acc;
+    return (*this);
 }
 
 
@@ -61,61 +124,54 @@ void solver::euler(const double years, const std::string folder)
     
     int timesteps;
     double h;
-    string path;
-    ofstream output;
+    double start = _time;
     
     timesteps = (int) (years * 250);
     h = ((double) years) / ((double) timesteps);
     
+    if(_pending)
+    {
+        finalize(false);
+    }
+    
+    _open_output(folder, "Euler algorithm (2D)", years, h);
+    _open_perihelions(h);
+    _start_dense(years);
+    _open_ephemeris(folder, start, years);
+    _start_writer(false, years);
+    
     //  go through every time-step, then every planet
     for(int i = 0; i <= timesteps; i++)
     {
-        for(int k = 0; k < _card; k++)
+        if(_dense_interval == 0.)
         {
-            path = folder + _system[k].name();
-            
-            if(i == 0)
-            {
-                //  only write the header once
-                output.open(path);
-                output << "Euler algorithm (2D)" << endl;
-                output << _system[k].name() << " (x, y, vx, vy)" << endl;
-                output << "Timestep: " << years << " years" << endl << endl;
-            }
-            else
-            {
-                output.open(path, ios::app);   //  write after the existing content
-            }
-            
-            _system[k].print_pos(output);   //  prints quantities for a gnuplot
-            _system[k].print_vel(output);
-            output << endl;
-            
-            //  then perform the algorithm
-            //  _prev_pos and vel are initialized when a planet is added
-            //  see solver::add
-            _system[k].position[0] = h * _prev_vel[k][0] + _prev_pos[k][0];
-            _system[k].position[1] = h * _prev_vel[k][1] + _prev_pos[k][1];
-            
-            _system[k].velocity[0] = h * _prev_acc[k][0] + _prev_vel[k][0];
-            _system[k].velocity[1] = h * _prev_acc[k][1] + _prev_vel[k][1];
-            
-            output.close();
+            _output_positions(i, start + i * h, false, years);
         }
         
-        _print_kinetic_energy(i, folder);
-        _print_potential_energy(i, folder);
-        _print_total_energy(i, folder);
-        _update_quantities(i, h);   //  update the _prev_vectors
+        //  then perform the algorithm
+        _save_step();
+        _euler_step(h);
+        
+        //  the energies don't change anything, so they can use the force pass
+        _next_acceleration(false);
+        _particle_acceleration();
+        _output_energies();
+        _dense_output(start, start + i * h, h, years);
+        _ephemeris_output(start, start + i * h, h);
+        _detect_perihelions(start + i * h, h);
+        _update_quantities(start + (i + 1) * h);   //  update the prev_ vectors
+        _periodic_checkpoint(i, _time);
     }
     
+    _stop_writer();
+    _wait_checkpoint();
+    _output.close();
+    
     //  create gnuplot scripts
     _gnuplot(folder, years);
     _gnuplot_png(folder, years);
     _gnuplot_energies(folder, years);
     _gnuplot_energies_png(folder, years);
-    
-    _time += years;
 }
 
 ////////
@@ -130,23 +186,48 @@ void solver::verlet(const double years, const std::string folder, const bool rel
     
     int timesteps;
     double h;
-    double h_squared;
-    double radical;
+    double start = _time;
     bool can_write;
-    bool mass_center;
-    string path;
-    ofstream output;
-    vector<vector<double>> next_acc;
+    bool verlet = (_dense_interval == 0.);  //  the dense output writes every body at every time, like euler
+    int mercury = -1;   //  the only body whose perihelions are written
     
-    if(relativity && !highres)
+    //  with solver::perihelions, a smaller number of steps is enough
+    if(relativity && !highres && _steps == 0)
     {
-        cout << "You can't compute the relativity without a high-res." << endl;
+        cout << "You can't compute the relativity without a high-res or a number of steps." << endl;
         exit (1);
     }
     
-    timesteps = (relativity || highres) ? ((int) years * 9072000) : ((int) years * 365);
+    if(_steps > 0)
+    {
+        timesteps = (int) (years * _steps);
+    }
+    else
+    {
+        timesteps = (relativity || highres) ? ((int) years * 9072000) : ((int) years * 365);
+    }
     h = ((double) years) / ((double) timesteps);
-    h_squared = h * h;
+    
+    if(_pending)
+    {
+        finalize(relativity);
+    }
+    
+    //  the names are compared once, not at each step
+    for(int k = 0; k < _card && (relativity || highres); k++)
+    {
+        if(_system.name[k] == "mercury")
+        {
+            mercury = k;
+        }
+    }
+    
+    //  the layout of the files is told by their first line, see snapshots::text
+    _open_output(folder, verlet ? "Velocity-Verlet algorithm (2D)" : "Velocity-Verlet (2D), dense", years, h);
+    _open_perihelions(h);
+    _start_dense(years);
+    _open_ephemeris(folder, start, years);
+    _start_writer(verlet, years);
     
     for(int i = 0; i <= timesteps; i++)
     {
@@ -155,51 +236,51 @@ void solver::verlet(const double years, const std::string folder, const bool rel
         //  as a consequence, it outputs only a few values
         can_write = (relativity || highres) ? (i % 24800 == 0) : true;
         
-        for(int k = 0; k < _card; k++)
+        if(mercury >= 0)
         {
-            mass_center = _system[k].distance_center() == 0;
-            _perihelion_output(relativity, highres, k, i, years, folder);
-            _first_output(k, i, years, folder);
-            
-            if(!mass_center)
-            {
-                _classic_output(can_write, k, i, folder);
-                
-                radical = 0.5 * h_squared;
-                _system[k].position[0] = _prev_pos[k][0] + h * _prev_vel[k][0] + radical * _prev_acc[k][0];
-                _system[k].position[1] = _prev_pos[k][1] + h * _prev_vel[k][1] + radical * _prev_acc[k][1];
-            }
+            _perihelion_output(relativity, highres, mercury, i, years);
         }
         
-        //  computes the new acceleration with the just calculated position
-        //  note that the first initialization of _prev_acc can be done with relativity, see solver::add
-        _next_acc = _next_acceleration(relativity);
-        
-        for(int k = 0; k < _card; k++)
+        if(can_write && verlet)
         {
-            mass_center = _system[k].distance_center() == 0;
-            if(!mass_center)
-            {
-                radical = 0.5 * h;
-                _system[k].velocity[0] = _prev_vel[k][0] + radical * (_prev_acc[k][0] + _next_acc[k][0]);
-                _system[k].velocity[1] = _prev_vel[k][1] + radical * (_prev_acc[k][1] + _next_acc[k][1]);
-            }
+            _output_positions(i, start + i * h, true, years);
         }
         
+        _save_step();
+        _verlet_step(h, relativity);
+        
         //  we don't print the energies for the relativistic case
         //  they indeed would need a correction too
         if(can_write && !relativity)
         {
-            _print_kinetic_energy(i, folder);
-            _print_potential_energy(i, folder);
-            _print_total_energy(i, folder);
+            _output_energies();
         }
         
-        //  update of the _prev_vectors
-        _update_quantities(i, h, _next_acc);
+        _dense_output(start, start + i * h, h, years);
+        _ephemeris_output(start, start + i * h, h);
+        _detect_perihelions(start + i * h, h);
+        
+        //  update of the prev_ vectors
+        _update_quantities(start + (i + 1) * h);
+        _periodic_checkpoint(i, _time);
 
     }
     
+    _stop_writer();
+    _wait_checkpoint();
+    _output.close();
+    
+    //  the kicks of Forest-Ruth are not at the final positions, see solver::_update_quantities
+    if(_scheme == forest_ruth)
+    {
+        _next_acceleration(relativity);
+        _particle_acceleration();
+        _system.prev_ax.swap(_system.next_ax);
+        _system.prev_ay.swap(_system.next_ay);
+        _particles.prev_ax.swap(_particles.next_ax);
+        _particles.prev_ay.swap(_particles.next_ay);
+    }
+    
     _gnuplot(folder, years);
     _gnuplot_png(folder, years);
     if(!relativity)
@@ -207,8 +288,127 @@ void solver::verlet(const double years, const std::string folder, const bool rel
         _gnuplot_energies(folder, years);
         _gnuplot_energies_png(folder, years);
     }
+}
+
+////////
+
+void solver::wisdom_holman(const double years, const std::string folder, const int steps)
+{
+    //  the motion is split in two parts, computed one after the other:
+    //  the Kepler orbit of each body around the central body (the most massive one), solved exactly by kepler_drift
+    //  and the small interactions between the other bodies, given as kicks on the velocities
+    //  kick(h/2) drift(h) kick(h/2) is symplectic: the energy error stays bounded with steps of a few days
+    //  see solver::_wisdom_holman_step for the coordinates
     
-    _time += years;
+    int timesteps;
+    double h;
+    double start = _time;
+    int central = _central_body();
+    
+    timesteps = (int) (years * steps);
+    h = ((double) years) / ((double) timesteps);
+    
+    _check_particles("wisdom_holman");
+    
+    //  the kicks subtract the exact attraction of the central body from the accelerations, see solver::_interaction_kick
+    //  so they must not be approximated by the tree
+    if(_method == barnes_hut)
+    {
+        cout << "The Wisdom-Holman algorithm is not available with the Barnes-Hut tree." << endl;
+        exit(1);
+    }
+    _open_output(folder, "Wisdom-Holman algorithm (2D)", years, h);
+    _start_writer(false, years);
+    
+    //  the first kick needs the accelerations at the initial positions, the next ones are computed by the steps
+    _next_acceleration(false);
+    
+    for(int i = 0; i <= timesteps; i++)
+    {
+        _output_positions(i, start + i * h, false, years);
+        
+        if(i < timesteps)
+        {
+            _wisdom_holman_step(central, h);
+            
+            _time = start + (i + 1) * h;
+            _system.time = _time;
+            _output_energies();
+        }
+    }
+    
+    _stop_writer();
+    _output.close();
+    
+    //  euler and verlet can go on from the new positions, see solver::_update_quantities
+    _system.save();
+    _system.prev_ax.swap(_system.next_ax);
+    _system.prev_ay.swap(_system.next_ay);
+    
+    _gnuplot(folder, years);
+    _gnuplot_png(folder, years);
+    _gnuplot_energies(folder, years);
+    _gnuplot_energies_png(folder, years);
+    
+    _time = start + years;
+}
+
+////////
+
+void solver::hermite(const double years, const std::string folder, const int steps)
+{
+    //  fourth order predictor-corrector using the acceleration and its derivative, the jerk
+    //  one force evaluation per step, like Verlet, but the error decreases like h^4
+    //  J. Makino and S. J. Aarseth, On a Hermite integrator with Ahmad-Cohen scheme, PASJ 44 (1992)
+    
+    int timesteps;
+    double h;
+    double start = _time;
+    
+    timesteps = (int) (years * steps);
+    h = ((double) years) / ((double) timesteps);
+    
+    _check_particles("hermite");
+    _open_output(folder, "Hermite algorithm (2D)", years, h);
+    _start_writer(false, years);
+    
+    //  accelerations and jerks at the initial positions, then at the end of each step
+    _jerks.assign(4 * _card, 0.);
+    _hermite_acceleration();
+    _system.save();
+    _system.prev_ax.swap(_system.next_ax);
+    _system.prev_ay.swap(_system.next_ay);
+    swap_ranges(_jerks.begin(), _jerks.begin() + 2 * _card, _jerks.begin() + 2 * _card);
+    
+    for(int i = 0; i <= timesteps; i++)
+    {
+        _output_positions(i, start + i * h, false, years);
+        
+        if(i < timesteps)
+        {
+            _hermite_step(h);
+            
+            _time = start + (i + 1) * h;
+            _system.time = _time;
+            _output_energies();
+            
+            _system.save();
+            _system.prev_ax.swap(_system.next_ax);
+            _system.prev_ay.swap(_system.next_ay);
+            swap_ranges(_jerks.begin(), _jerks.begin() + 2 * _card, _jerks.begin() + 2 * _card);
+        }
+    }
+    
+    _stop_writer();
+    _output.close();
+    
+    //  the prev_ vectors are at the final positions: euler and verlet can go on from here
+    _gnuplot(folder, years);
+    _gnuplot_png(folder, years);
+    _gnuplot_energies(folder, years);
+    _gnuplot_energies_png(folder, years);
+    
+    _time = start + years;
 }
 
 
@@ -234,6 +434,27 @@ double solver::time(void) const
     return (_time);
 }
 
+////////
+
+long solver::stalls(void) const
+{
+    return (_stalls);
+}
+
+////////
+
+long solver::evaluations(void) const
+{
+    return (_evaluations);
+}
+
+////////
+
+std::vector<int> solver::rungs(void) const
+{
+    return (_rungs);
+}
+
 
 //  methods
 
@@ -242,9 +463,9 @@ double solver::kinetic_energy(void) const
 {
     double energy = 0.;
     
-    for(auto& body : _system)
+    for(int k = 0; k < _card; k++)
     {
-        energy += body.kinetic_energy();
+        energy += 0.5 * _system.m[k] * (_system.vx[k] * _system.vx[k] + _system.vy[k] * _system.vy[k]);
     }
     
     return (energy);
@@ -254,11 +475,28 @@ double solver::kinetic_energy(void) const
 
 double solver::potential_energy(void) const
 {
+    //  same convention as planet::potential_energy(system)
+    double const g_const = 4 * M_PI * M_PI;
     double energy = 0.;
+    double dx, dy, r;
     
-    for(auto& body : _system)
+    for(int p = 0; p < _card; p++)
     {
-        energy += body.potential_energy(_system);   //  this method is in planet
+        double body_energy = 0.;
+        
+        for(int k = 0; k < _card; k++)
+        {
+            dx = _system.x[p] - _system.x[k];
+            dy = _system.y[p] - _system.y[k];
+            r = sqrt(dx * dx + dy * dy);
+            
+            if(r != 0.)
+            {
+                body_energy -= (g_const * _system.m[p] * _system.m[k]) / (r * r);
+            }
+        }
+        
+        energy += body_energy;
     }
     
     return (energy);
@@ -275,7 +513,8 @@ double solver::total_energy(void) const
 
 ////////
 
-void solver::add(planet body, const bool relativity)
+//  the accelerations of the bodies already there change too: they are all computed by finalize, once before the run
+void solver::add(planet body, const bool)
 {
     _card++;
     
@@ -285,10 +524,191 @@ void solver::add(planet body, const bool relativity)
     //  normalize the mass and the velocity
     body.normalize();
     _system.push_back(body);
-    _prev_pos.push_back(body.position);
-    _prev_vel.push_back(body.velocity);
-    _prev_acc.push_back(_acceleration(_card - 1, relativity));
-    //  the new planet is the (_card - 1) celestial body of the system
+    _pending = true;
+}
+
+////////
+
+void solver::add_many(const std::vector<planet>& planets)
+{
+    bodies table;
+    
+    for(auto& body : planets)
+    {
+        table.name.push_back(body.name());
+        table.m.push_back(body.mass());
+        table.x.push_back(body.position[0]);
+        table.y.push_back(body.position[1]);
+        table.vx.push_back(body.velocity[0]);
+        table.vy.push_back(body.velocity[1]);
+    }
+    
+    _add_table(table);
+}
+
+////////
+
+void solver::load(const std::string path, const double mass)
+{
+    bodies table;
+    
+    if(!read_table(path, mass, table))
+    {
+        cout << "Can't read the initial conditions " << path << endl;
+        exit(1);
+    }
+    
+    _add_table(table);
+}
+
+////////
+
+//  one pass for the accelerations of all the bodies, with the engine and the threads of the solver
+void solver::finalize(const bool relativity)
+{
+    _next_acceleration(relativity);
+    _particle_acceleration();
+    _system.prev_ax.swap(_system.next_ax);
+    _system.prev_ay.swap(_system.next_ay);
+    _particles.prev_ax.swap(_particles.next_ax);
+    _particles.prev_ay.swap(_particles.next_ay);
+    _pending = false;
+}
+
+////////
+
+//  the mass of a test particle is kept, but it is never used: it doesn't count in the mass center and the energies
+void solver::add_particle(planet body)
+{
+    int n;
+    
+    body.normalize();
+    _particles.push_back(body);
+    n = _particles.size();
+    _particle_acceleration(n - 1, n, _particles.prev_ax.data(), _particles.prev_ay.data());
+}
+
+////////
+
+void solver::force(const force_method method, const double theta)
+{
+    _method = method;
+    _tree = tree(theta);
+}
+
+////////
+
+void solver::threads(const int n)
+{
+    _threads = (n > 0) ? n : 1;
+}
+
+////////
+
+void solver::format(const output_format format)
+{
+    _format = format;
+}
+
+////////
+
+void solver::energy(const energy_method method)
+{
+    _energy = method;
+}
+
+////////
+
+void solver::scheme(const integration_scheme scheme)
+{
+    _scheme = scheme;
+}
+
+////////
+
+void solver::steps(const int steps)
+{
+    _steps = (steps > 0) ? steps : 0;
+}
+
+////////
+
+void solver::asynchronous(const int capacity)
+{
+    _capacity = (capacity > 0) ? capacity : 0;
+}
+
+////////
+
+void solver::checkpoint(const std::string path) const
+{
+    write_checkpoint(path, _checkpoint_header(_time), _system, _particles);
+}
+
+////////
+
+void solver::restore(const std::string path)
+{
+    checkpoint_header header;
+    
+    if(!read_checkpoint(path, header, _system, _particles))
+    {
+        cout << "The checkpoint " << path << " can't be read." << endl;
+        exit(1);
+    }
+    
+    _card = header.bodies;
+    _time = header.time;
+    _total_mass = header.total_mass;
+    _mass_center = {header.mass_center[0], header.mass_center[1]};
+    _potential_ready = false;
+    _pending = false;   //  the accelerations are in the checkpoint
+}
+
+////////
+
+void solver::checkpoints(const std::string path, const int steps)
+{
+    _checkpoint_path = path;
+    _checkpoint_steps = (steps > 0) ? steps : 0;
+}
+
+////////
+
+void solver::dense(const double interval)
+{
+    _dense_interval = (interval > 0.) ? interval : 0.;
+}
+
+////////
+
+void solver::chebyshev(const double span, const int coefficients)
+{
+    _ephemeris_span = (span > 0.) ? span : 0.;
+    _ephemeris_size = (coefficients > 2) ? coefficients : 2;
+}
+
+////////
+
+void solver::perihelions(const std::string name)
+{
+    _perihelion_names.push_back(name);
+}
+
+////////
+
+std::vector<std::vector<double>> solver::acceleration(const bool relativity)
+{
+    vector<vector<double>> acceleration(_card);
+    
+    _next_acceleration(relativity);
+    
+    for(int k = 0; k < _card; k++)
+    {
+        acceleration[k] = {_system.next_ax[k], _system.next_ay[k]};
+    }
+    
+    return (acceleration);
 }
 
 ////////
@@ -300,7 +720,7 @@ void solver::print(ofstream& file) const
     
     for(int p = 0; p < _card ; p++)
     {
-        _system[p].print(file); //  planet:: method
+        _system.body(p).print(file); //  planet:: method
     }
     
     file << "===/ CELESTIAL SYSTEM === " << endl;
@@ -315,11 +735,49 @@ vector<double> solver::mass_center(void) const
 
 std::vector<planet> solver::system(void) const
 {
-    return (_system);
+    vector<planet> system;
+    
+    for(int k = 0; k < _card; k++)
+    {
+        system.push_back(_system.body(k));
+    }
+    
+    return (system);
+}
+
+std::vector<planet> solver::particles(void) const
+{
+    vector<planet> particles;
+    
+    for(int k = 0; k < _particles.size(); k++)
+    {
+        particles.push_back(_particles.body(k));
+    }
+    
+    return (particles);
 }
 
 
-///////
+////////
+
+//  the energies and the perihelions are always written in text files
+//  algorithm is the first line of the text files, snapshots::text needs it to write them back
+
+void solver::_open_output(const std::string folder, const std::string algorithm, const double years, const double h)
+{
+    _algorithm = algorithm;
+    
+    if(_format == binary)
+    {
+        _output.open_binary(folder, _system, algorithm, years, h);
+    }
+    else
+    {
+        _output.open(folder, _system);
+    }
+}
+
+////////
 
 //  some gnuplot scripts
 
@@ -344,8 +802,8 @@ void solver::_gnuplot(const std::string folder, const double years) const
     
     for(int k = 0; k < _card; k++)
     {
-        path[k] = "'" + folder + _system[k].name() + "'";
-        title = " title '" + _system[k].name() + "'";
+        path[k] = "'" + folder + _system.name[k] + "'";
+        title = " title '" + _system.name[k] + "'";
         
         if(k == 0)
         {
@@ -385,8 +843,8 @@ void solver::_gnuplot_png(const std::string folder, const double years) const
     
     for(int k = 0; k < _card; k++)
     {
-        path[k] = "'" + folder + _system[k].name() + "'";
-        title = " title '" + _system[k].name() + "'";
+        path[k] = "'" + folder + _system.name[k] + "'";
+        title = " title '" + _system.name[k] + "'";
         
         if(k == 0)
         {
@@ -461,200 +919,571 @@ void solver::_gnuplot_energies_png(const std::string folder, const double years)
 
 ////////
 
-void solver::_print_kinetic_energy(const int i, const std::string folder) const
+//  the file is erased the first time, see trajectory::file
+//  it stays open, so we go back to the default precision for the time
+void solver::_print_energy(const std::string& name, const double time, const double energy)
 {
-    ofstream output;
+    ofstream& output = _output.file(name);
     string space = "        ";
     
-    if(i == 0)
+    output << setprecision(6) << time << setprecision(12) << space << energy << '\n';
+}
+
+////////
+
+void solver::_update_mass_center(const planet& body)
+{
+    double total_mass;
+    
+    _mass_center[0] *= _total_mass;
+    _mass_center[1] *= _total_mass;
+    
+    total_mass = _total_mass + body.mass();
+    
+    _mass_center[0] += body.mass() * body.position[0];
+    _mass_center[1] += body.mass() * body.position[1];
+    _mass_center[0] /= total_mass;
+    _mass_center[1] /= total_mass;
+}
+
+////////
+
+//  what solver::add does for each body, for a whole table: the mass center and the normalization of planet::normalize
+//  go through the arrays once, and the accelerations are left to solver::finalize
+void solver::_add_table(bodies& table)
+{
+    int n = table.size();
+    int total = _card + n;
+    double mass = 0.;
+    double x = 0.;
+    double y = 0.;
+    
+    OMP(simd reduction(+:mass, x, y))
+    for(int k = 0; k < n; k++)
     {
-        output.open(folder + "system-kinetic-energy");
+        mass += table.m[k];
+        x += table.m[k] * table.x[k];
+        y += table.m[k] * table.y[k];
     }
-    else
+    
+    _mass_center[0] = (_mass_center[0] * _total_mass + x) / (_total_mass + mass);
+    _mass_center[1] = (_mass_center[1] * _total_mass + y) / (_total_mass + mass);
+    _total_mass += mass;
+    
+    OMP(simd)
+    for(int k = 0; k < n; k++)
     {
-        output.open(folder + "system-kinetic-energy", ios::app);
+        table.m[k] /= 2.E30;
+        table.vx[k] *= 365.25;
+        table.vy[k] *= 365.25;
     }
-    output << _time << setprecision(12) << space << kinetic_energy() << endl;
     
-    output.close();
+    _system.name.insert(_system.name.end(), make_move_iterator(table.name.begin()), make_move_iterator(table.name.end()));
+    _system.m.insert(_system.m.end(), table.m.begin(), table.m.end());
+    _system.x.insert(_system.x.end(), table.x.begin(), table.x.end());
+    _system.y.insert(_system.y.end(), table.y.begin(), table.y.end());
+    _system.vx.insert(_system.vx.end(), table.vx.begin(), table.vx.end());
+    _system.vy.insert(_system.vy.end(), table.vy.begin(), table.vy.end());
+    _system.prev_x.insert(_system.prev_x.end(), table.x.begin(), table.x.end());
+    _system.prev_y.insert(_system.prev_y.end(), table.y.begin(), table.y.end());
+    _system.prev_vx.insert(_system.prev_vx.end(), table.vx.begin(), table.vx.end());
+    _system.prev_vy.insert(_system.prev_vy.end(), table.vy.begin(), table.vy.end());
+    _system.prev_ax.resize(total, 0.);
+    _system.prev_ay.resize(total, 0.);
+    _system.next_ax.resize(total, 0.);
+    _system.next_ay.resize(total, 0.);
+    _card = total;
+    _pending = true;
 }
 
 ////////
 
-void solver::_print_potential_energy(const int i, const std::string folder) const
+//  the prev_ vectors are initialized when a planet is added, see solver::add
+//  the files are written before, so the loops over the bodies can be shared between the threads
+//  the test particles are moved with the planets, see solver::add_particle
+void solver::_euler_step(const double h)
 {
-    ofstream output;
-    string space = "        ";
+    _euler_step(h, _system);
+    _euler_step(h, _particles);
+}
+
+void solver::_euler_step(const double h, bodies& system)
+{
+    int n = system.size();
     
-    if(i == 0)
+    OMP(parallel for num_threads(_threads) schedule(static))
+    for(int k = 0; k < n; k++)
     {
-        output.open(folder + "system-potential-energy");
+        system.x[k] = h * system.prev_vx[k] + system.prev_x[k];
+        system.y[k] = h * system.prev_vy[k] + system.prev_y[k];
+        
+        system.vx[k] = h * system.prev_ax[k] + system.prev_vx[k];
+        system.vy[k] = h * system.prev_ay[k] + system.prev_vy[k];
     }
-    else
+}
+
+////////
+
+//  x(t+dt) = x(t) + dt*v(t) + (1/2)(dt^2)*a(t)
+void solver::_verlet_positions(const double h)
+{
+    _verlet_positions(h, _system);
+    _verlet_positions(h, _particles);
+}
+
+void solver::_verlet_positions(const double h, bodies& system)
+{
+    double radical = 0.5 * h * h;
+    int n = system.size();
+    
+    OMP(parallel for num_threads(_threads) schedule(static))
+    for(int k = 0; k < n; k++)
     {
-        output.open(folder + "system-potential-energy", ios::app);
+        if(!system.center(k))
+        {
+            system.x[k] = system.prev_x[k] + h * system.prev_vx[k] + radical * system.prev_ax[k];
+            system.y[k] = system.prev_y[k] + h * system.prev_vy[k] + radical * system.prev_ay[k];
+        }
     }
-    output << _time << setprecision(12) << space << potential_energy() << endl;
+}
+
+////////
+
+//  v(t+dt) = v(t) + (1/2)*dt*[a(t) + a(t+dt)]
+void solver::_verlet_velocities(const double h)
+{
+    _verlet_velocities(h, _system);
+    _verlet_velocities(h, _particles);
+}
+
+void solver::_verlet_velocities(const double h, bodies& system)
+{
+    double radical = 0.5 * h;
+    int n = system.size();
     
-    output.close();
+    OMP(parallel for num_threads(_threads) schedule(static))
+    for(int k = 0; k < n; k++)
+    {
+        if(!system.center(k))
+        {
+            system.vx[k] = system.prev_vx[k] + radical * (system.prev_ax[k] + system.next_ax[k]);
+            system.vy[k] = system.prev_vy[k] + radical * (system.prev_ay[k] + system.next_ay[k]);
+        }
+    }
 }
 
+////////
+
+//  one step of verlet with the chosen scheme, see solver::integration_scheme
+//  the compositions are velocity Verlet steps of w * h, with some w negative, whose errors cancel up to the order 4 or 6
+//  the acceleration at the end of a step is the one at the beginning of the next: one force evaluation per step
+//  H. Yoshida, Construction of higher order symplectic integrators, Physics Letters A 150 (1990)
+void solver::_verlet_step(const double h, const bool relativity)
+{
+    static const double cube_root = cbrt(2.);
+    static const double triple_jump[3] = {1. / (2. - cube_root), -cube_root / (2. - cube_root), 1. / (2. - cube_root)};
+    static const double w1 = -1.17767998417887;
+    static const double w2 = 0.235573213359357;
+    static const double w3 = 0.784513610477560;
+    static const double sixth_order[7] = {w3, w2, w1, 1. - 2. * (w1 + w2 + w3), w1, w2, w3};
+    const double* weights = nullptr;
+    int substeps = 1;
+    double theta = triple_jump[0];
+    
+    if(_scheme == forest_ruth)
+    {
+        //  E. Forest and R. D. Ruth, Fourth-order symplectic integration, Physica D 43 (1990)
+        _drift(0.5 * theta * h);
+        _kick(theta * h, relativity);
+        _drift(0.5 * (1. - theta) * h);
+        _kick((1. - 2. * theta) * h, relativity);
+        _drift(0.5 * (1. - theta) * h);
+        _kick(theta * h, relativity);
+        _drift(0.5 * theta * h);
+        return;
+    }
+    
+    if(_scheme == yoshida4)
+    {
+        weights = triple_jump;
+        substeps = 3;
+    }
+    else if(_scheme == yoshida6)
+    {
+        weights = sixth_order;
+        substeps = 7;
+    }
+    
+    for(int j = 0; j < substeps; j++)
+    {
+        double step = (weights == nullptr) ? h : weights[j] * h;
+        
+        if(j != 0)
+        {
+            _system.save();
+            _system.prev_ax.swap(_system.next_ax);
+            _system.prev_ay.swap(_system.next_ay);
+            _particles.save();
+            _particles.prev_ax.swap(_particles.next_ax);
+            _particles.prev_ay.swap(_particles.next_ay);
+        }
+        
+        _verlet_positions(step);
+        
+        //  computes the new acceleration with the just calculated position
+        //  note that the first initialization of prev_ax can be done with relativity, see solver::add
+        _next_acceleration(relativity);
+        _particle_acceleration();
+        
+        _verlet_velocities(step);
+    }
+}
 
 ////////
 
-void solver::_print_total_energy(const int i, const std::string folder) const
+//  predictor: Taylor series with the acceleration and the jerk at ti
+//  corrector: with the acceleration and the jerk at the predicted positions, the mass center stays fixed
+void solver::_hermite_step(const double h)
 {
-    ofstream output;
-    string space = "        ";
+    const double* prev_jx = _jerks.data();
+    const double* prev_jy = prev_jx + _card;
+    const double* next_jx = prev_jy + _card;
+    const double* next_jy = next_jx + _card;
+    double h2 = h * h / 2.;
+    double h3 = h * h * h / 6.;
+    double h12 = h * h / 12.;
     
-    if(i == 0)
+    OMP(parallel for num_threads(_threads) schedule(static))
+    for(int k = 0; k < _card; k++)
     {
-        output.open(folder + "system-total-energy");
+        if(!_system.center(k))
+        {
+            _system.x[k] = _system.prev_x[k] + h * _system.prev_vx[k] + h2 * _system.prev_ax[k] + h3 * prev_jx[k];
+            _system.y[k] = _system.prev_y[k] + h * _system.prev_vy[k] + h2 * _system.prev_ay[k] + h3 * prev_jy[k];
+            _system.vx[k] = _system.prev_vx[k] + h * _system.prev_ax[k] + h2 * prev_jx[k];
+            _system.vy[k] = _system.prev_vy[k] + h * _system.prev_ay[k] + h2 * prev_jy[k];
+        }
     }
-    else
+    
+    _hermite_acceleration();
+    
+    OMP(parallel for num_threads(_threads) schedule(static))
+    for(int k = 0; k < _card; k++)
     {
-        output.open(folder + "system-total-energy", ios::app);
+        if(!_system.center(k))
+        {
+            _system.vx[k] = _system.prev_vx[k] + 0.5 * h * (_system.prev_ax[k] + _system.next_ax[k]) + h12 * (prev_jx[k] - next_jx[k]);
+            _system.vy[k] = _system.prev_vy[k] + 0.5 * h * (_system.prev_ay[k] + _system.next_ay[k]) + h12 * (prev_jy[k] - next_jy[k]);
+            _system.x[k] = _system.prev_x[k] + 0.5 * h * (_system.prev_vx[k] + _system.vx[k]) + h12 * (_system.prev_ax[k] - _system.next_ax[k]);
+            _system.y[k] = _system.prev_y[k] + 0.5 * h * (_system.prev_vy[k] + _system.vy[k]) + h12 * (_system.prev_ay[k] - _system.next_ay[k]);
+        }
     }
-    output << _time << setprecision(12) << space << total_energy() << endl;
     
-    output.close();
+    //  the force pass was done at the predicted positions
+    _potential_ready = false;
 }
 
 ////////
 
-void solver::_update_mass_center(const planet& body)
+//  x(t+dt) = x(t) + dt*v(t), the mass center stays fixed
+//  the positions change, so the potential energy of the last force pass can't be used any more
+void solver::_drift(const double h)
 {
-    double total_mass;
+    _drift(h, _system);
+    _drift(h, _particles);
     
-    _mass_center[0] *= _total_mass;
-    _mass_center[1] *= _total_mass;
+    _potential_ready = false;
+}
+
+void solver::_drift(const double h, bodies& system)
+{
+    int n = system.size();
     
-    total_mass = _total_mass + body.mass();
+    OMP(parallel for num_threads(_threads) schedule(static))
+    for(int k = 0; k < n; k++)
+    {
+        if(!system.center(k))
+        {
+            system.x[k] += h * system.vx[k];
+            system.y[k] += h * system.vy[k];
+        }
+    }
+}
+
+////////
+
+//  v(t+dt) = v(t) + dt*a(t), with the acceleration at the current positions
+void solver::_kick(const double h, const bool relativity)
+{
+    _next_acceleration(relativity);
+    _particle_acceleration();
     
-    _mass_center[0] += body.mass() * body.position[0];
-    _mass_center[1] += body.mass() * body.position[1];
-    _mass_center[0] /= total_mass;
-    _mass_center[1] /= total_mass;
+    _kick(h, _system);
+    _kick(h, _particles);
+}
+
+void solver::_kick(const double h, bodies& system)
+{
+    int n = system.size();
+    
+    OMP(parallel for num_threads(_threads) schedule(static))
+    for(int k = 0; k < n; k++)
+    {
+        system.vx[k] += h * system.next_ax[k];
+        system.vy[k] += h * system.next_ay[k];
+    }
 }
 
 ////////
 
-//  this one is for Euler, where we don't need the next acceleration
-void solver::_update_quantities(const int i, const double h)
+//  the other algorithms don't move the test particles, they would stay where they are
+void solver::_check_particles(const std::string algorithm) const
 {
-    for(int k = 0; k < _card; k++)
+    if(_particles.size() != 0)
     {
-        _prev_pos[k] = _system[k].position;
-        _prev_vel[k] = _system[k].velocity;
-        _prev_acc[k] = _acceleration(k, false);
-        _system[k].time = i * h;
+        cout << "The test particles are only moved by euler and verlet, not by " << algorithm << "." << endl;
+        exit(1);
     }
-    _time = i * h;
 }
 
 ////////
 
-//  this one is for Verlet
-void solver::_update_quantities(const int i, const double h, std::vector<std::vector<double>> acc)
+int solver::_central_body(void) const
 {
-    for(int k = 0; k < _card; k++)
+    int central = 0;
+    
+    for(int k = 1; k < _card; k++)
     {
-        _prev_pos[k] = _system[k].position;
-        _prev_vel[k] = _system[k].velocity;
-        _system[k].time = i * h;
+        if(_system.m[k] > _system.m[central])
+        {
+            central = k;
+        }
     }
     
-    //  it has been calculated once in Verlet, so we avoid a calculation
-    _prev_acc = acc;
-    _time = i * h;
+    return (central);
 }
 
-
 ////////
 
-//  only one method for a relativistic or non-relativistic simulation
-vector<double> solver::_acceleration(const int p, const bool relativity) const
+//  democratic heliocentric coordinates: the position of a body relative to the central body c
+//  and its velocity relative to the mass center, the central body is given by the conservation of momentum
+//  the jump is the motion of the central body, moved to the positions of the others
+//  if c is the fixed mass center (see solver::_acceleration), there is no jump and the velocities don't change
+//  _system.next_ax and _system.next_ay must contain the accelerations at the current positions
+void solver::_wisdom_holman_step(const int c, const double h)
 {
-    //  p is the index of the planet for which we calculate eta
+    double* qx;
+    double* qy;
+    double* wx;
+    double* wy;
+    double mu = 4 * M_PI * M_PI * _system.m[c];
+    bool fixed = _system.center(c);
+    double total_mass = 0.;
+    double center_x = 0.;
+    double center_y = 0.;
+    double center_vx = 0.;
+    double center_vy = 0.;
+    double sum_x = 0.;
+    double sum_y = 0.;
     
-    double const g_const = 4 * M_PI * M_PI;
-    double radical; //  just a variable to avoid calculations
-    double r;
-    vector<double> relative_pos = {0., 0.};
-    vector<double> acceleration = {0., 0.};
+    //  after the first step, this doesn't allocate anything
+    _coordinates.resize(4 * _card);
+    qx = _coordinates.data();
+    qy = qx + _card;
+    wx = qy + _card;
+    wy = wx + _card;
+    
+    if(!fixed)
+    {
+        for(int k = 0; k < _card; k++)
+        {
+            total_mass += _system.m[k];
+            center_x += _system.m[k] * _system.x[k];
+            center_y += _system.m[k] * _system.y[k];
+            center_vx += _system.m[k] * _system.vx[k];
+            center_vy += _system.m[k] * _system.vy[k];
+        }
+        
+        center_x /= total_mass;
+        center_y /= total_mass;
+        center_vx /= total_mass;
+        center_vy /= total_mass;
+    }
+    
+    for(int k = 0; k < _card; k++)
+    {
+        qx[k] = _system.x[k] - _system.x[c];
+        qy[k] = _system.y[k] - _system.y[c];
+        wx[k] = _system.vx[k] - center_vx;
+        wy[k] = _system.vy[k] - center_vy;
+    }
+    
+    _interaction_kick(c, 0.5 * h);
+    
+    if(!fixed)
+    {
+        _jump(c, 0.5 * h);
+    }
     
-    if(_system[p].distance_center() != 0.)  // the mass center must remain fixed
+    OMP(parallel for num_threads(_threads) schedule(static))
+    for(int k = 0; k < _card; k++)
+    {
+        if(k != c)
+        {
+            kepler_drift(mu, h, qx[k], qy[k], wx[k], wy[k]);
+        }
+    }
+    
+    if(!fixed)
     {
+        _jump(c, 0.5 * h);
+        
+        //  the mass center moves in a straight line
         for(int k = 0; k < _card; k++)
         {
-            if(k != p)
+            if(k != c)
             {
-                r = _system[p].distance(_system[k]);
-                double r_squared = r * r;
-                double r_cubed = r_squared * r;
-                radical = _system[k].mass() / r_cubed;
-                
-                relative_pos[0] = _system[p].position[0] - _system[k].position[0];  //  x - xk
-                relative_pos[1] = _system[p].position[1] - _system[k].position[1];
-                
-                acceleration[0] -= radical * relative_pos[0];
-                acceleration[1] -= radical * relative_pos[1];
-                if(relativity)
-                {
-                    double correction;
-                    double momentum;
-                    double const c = 63241.0770;
-                    momentum = _system[p].position[0] * _system[p].velocity[1] - _system[p].position[1] * _system[p].velocity[0];
-                    correction = 1. + (3. * momentum * momentum) / (r_squared * c * c);
-                    acceleration[0] *= correction;
-                    acceleration[1] *= correction;
-                }
+                sum_x += _system.m[k] * qx[k];
+                sum_y += _system.m[k] * qy[k];
             }
         }
-        acceleration[0] *= g_const ;
-        acceleration[1] *= g_const;
+        
+        _system.x[c] = center_x + h * center_vx - sum_x / total_mass;
+        _system.y[c] = center_y + h * center_vy - sum_y / total_mass;
     }
-    //  this concerns especially the sun when it is center of mass
-    //  this assures that it remains fix if the initial velocity is (0, 0)
-    else
+    
+    for(int k = 0; k < _card; k++)
     {
-        acceleration[0] = 0.;
-        acceleration[1] = 0.;
+        if(k != c)
+        {
+            _system.x[k] = qx[k] + _system.x[c];
+            _system.y[k] = qy[k] + _system.y[c];
+        }
     }
     
-    return (acceleration);
+    _next_acceleration(false);
+    _interaction_kick(c, 0.5 * h);
+    
+    if(!fixed)
+    {
+        sum_x = 0.;
+        sum_y = 0.;
+        
+        for(int k = 0; k < _card; k++)
+        {
+            if(k != c)
+            {
+                sum_x += _system.m[k] * wx[k];
+                sum_y += _system.m[k] * wy[k];
+            }
+        }
+        
+        _system.vx[c] = center_vx - sum_x / _system.m[c];
+        _system.vy[c] = center_vy - sum_y / _system.m[c];
+    }
+    
+    for(int k = 0; k < _card; k++)
+    {
+        if(k != c)
+        {
+            _system.vx[k] = wx[k] + center_vx;
+            _system.vy[k] = wy[k] + center_vy;
+        }
+    }
 }
 
 ////////
 
-//  it is just used in verlet to compute a(t+dt) when we want v(t)
-std::vector<std::vector<double>> solver::_next_acceleration(const bool relativity) const
+//  the interactions are what remains of the accelerations given by the force engine
+//  once the attraction of the central body is taken away
+void solver::_interaction_kick(const int c, const double h)
 {
-    vector<vector<double>> acceleration;
+    double mu = 4 * M_PI * M_PI * _system.m[c];
+    const double* qx = _coordinates.data();
+    const double* qy = qx + _card;
+    double* wx = _coordinates.data() + 2 * _card;
+    double* wy = wx + _card;
     
+    OMP(parallel for num_threads(_threads) schedule(static))
     for(int k = 0; k < _card; k++)
     {
-        acceleration.push_back(_acceleration(k, relativity));
+        if(k != c)
+        {
+            double r = sqrt(qx[k] * qx[k] + qy[k] * qy[k]);
+            double radical = mu / (r * r * r);
+            
+            wx[k] += h * (_system.next_ax[k] + radical * qx[k]);
+            wy[k] += h * (_system.next_ay[k] + radical * qy[k]);
+        }
     }
+}
+
+////////
+
+//  the momentum of the central body moves all the other bodies
+void solver::_jump(const int c, const double h)
+{
+    double* qx = _coordinates.data();
+    double* qy = qx + _card;
+    const double* wx = qy + _card;
+    const double* wy = wx + _card;
+    double momentum_x = 0.;
+    double momentum_y = 0.;
     
-    return (acceleration);
+    for(int k = 0; k < _card; k++)
+    {
+        if(k != c)
+        {
+            momentum_x += _system.m[k] * wx[k];
+            momentum_y += _system.m[k] * wy[k];
+        }
+    }
+    
+    for(int k = 0; k < _card; k++)
+    {
+        if(k != c)
+        {
+            qx[k] += h * momentum_x / _system.m[c];
+            qy[k] += h * momentum_y / _system.m[c];
+        }
+    }
+}
+
+////////
+
+//  a(t+dt) must have been calculated before, see solver::_next_acceleration
+void solver::_update_quantities(const double time)
+{
+    _system.save();
+    
+    //  swapping the vectors doesn't copy anything
+    _system.prev_ax.swap(_system.next_ax);
+    _system.prev_ay.swap(_system.next_ay);
+    _system.time = time;
+    _time = time;
+    
+    _particles.save();
+    _particles.prev_ax.swap(_particles.next_ax);
+    _particles.prev_ay.swap(_particles.next_ay);
+    _particles.time = _time;
 }
 
+
 ////////
 
 std::string solver::_gnuplot_colors(const int k) const
 {
     string color;
     
-    if(_system[k].name() == "earth") color = "\"blue\"";
-    else if(_system[k].name() == "jupiter") color = "\"light-goldenrod\"";
-    else if(_system[k].name() == "mercury") color = "\"orange-red\"";
-    else if(_system[k].name() == "mars") color = "\"brown\"";
-    else if(_system[k].name() == "neptune") color = "\"royalblue\"";
-    else if(_system[k].name() == "saturn") color = "\"goldenrod\"";
-    else if(_system[k].name() == "sun") color = "\"black\"";
-    else if(_system[k].name() == "uranus") color = "\"light-blue\"";
-    else if(_system[k].name() == "venus") color = "\"dark-goldenrod\"";
+    if(_system.name[k] == "earth") color = "\"blue\"";
+    else if(_system.name[k] == "jupiter") color = "\"light-goldenrod\"";
+    else if(_system.name[k] == "mercury") color = "\"orange-red\"";
+    else if(_system.name[k] == "mars") color = "\"brown\"";
+    else if(_system.name[k] == "neptune") color = "\"royalblue\"";
+    else if(_system.name[k] == "saturn") color = "\"goldenrod\"";
+    else if(_system.name[k] == "sun") color = "\"black\"";
+    else if(_system.name[k] == "uranus") color = "\"light-blue\"";
+    else if(_system.name[k] == "venus") color = "\"dark-goldenrod\"";
     else color = "dark-violet";
     
     return (color);
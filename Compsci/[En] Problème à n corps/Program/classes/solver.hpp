@@ -10,74 +10,240 @@
 #pragma once
 #include <vector>
 #include "planet.hpp"
+#include "bodies.hpp"
+#include "tree.hpp"
+#include "kernels.hpp"
+#include "trajectory.hpp"
+#include "ring.hpp"
+#include "checkpoint.hpp"
+#include <memory>
+#include <thread>
+#include <atomic>
 #include <fstream>
+#include <iomanip>
 #include <cmath>
 
 
 
 class solver
 {
-    friend class planet;
+    friend planet;
     
 public:
     
+    //  force engines used by euler and verlet
+    //  direct: exact O(N^2) sum, the reference (bit-compatible with the previous versions)
+    //  pairwise: exact sum visiting each pair once with Newton's third law, twice less operations
+    //  simd: exact sum with AVX2 or AVX-512 instructions if the processor has them, see kernels.hpp
+    //  barnes_hut: O(N log N) quadtree with an opening angle theta
+    enum force_method {direct, pairwise, simd, barnes_hut};
+    
+    //  formats of the data files written by euler and verlet
+    //  text: one file per body, binary: a single trajectory.bin, see snapshots.hpp
+    enum output_format {text, binary};
+    
+    //  ways to compute the energies written by euler and verlet
+    //  separate: the potential energy is summed over all the pairs again, after the force pass
+    //  fused: the pairwise engine sums it during the force pass, for almost nothing
+    //  (the other engines still compute it apart, the values agree up to the rounding errors)
+    enum energy_method {separate, fused};
+    
+    //  schemes used by verlet for each time-step, all symplectic
+    //  verlet2: velocity Verlet, second order, 1 force evaluation per step
+    //  yoshida4, yoshida6: Yoshida's compositions of 3 and 7 velocity Verlet steps, fourth and sixth order
+    //  forest_ruth: fourth order like yoshida4, in the drift-kick-drift form, 3 force evaluations per step
+    enum integration_scheme {verlet2, yoshida4, yoshida6, forest_ruth};
+    
     //  constructors
     
     solver(void);
     solver(const solver& other);
+    solver& operator=(const solver& other);     //  the threads, the files and the checkpoints are not copied
     
     //  main algorithms
     
     void euler(const double years, const std::string folder);
     void verlet(const double years, const std::string folder, const bool relativity = false, const bool highres = false);
+    void wisdom_holman(const double years, const std::string folder, const int steps = 100);  //  steps per year
+    void hermite(const double years, const std::string folder, const int steps = 365); //  steps per year
+    void dormand_prince(const double years, const std::string folder, const double tolerance = 1.E-10);    //  adaptive time-step
+    void block_verlet(const double years, const std::string folder, const int steps = 12, const double eta = 0.01); //  one time-step per body, see solver-adaptive.cpp
     
     //  getters
     
     int size(void) const;
     double time(void) const;
     double total_mass(void) const;
+    long stalls(void) const;    //  number of times the last run waited for the output thread
+    long evaluations(void) const;   //  number of force passes since the solver was created, a pass of block_verlet on a few bodies counts as one
+    std::vector<int> rungs(void) const; //  in the last step of block_verlet, the time-step of the body k was h / 2^rungs[k]
     
     //  methods
 
     double kinetic_energy(void) const;
     double potential_energy(void) const;
     double total_energy(void) const;
-    //  if you will calculate Verlet with a relativistic corection, you must specify it now
+    //  the accelerations are computed by finalize, with the relativity of the run: the flag is only kept for the older programs
     void add(planet body, const bool relativity = false);
+    void add_many(const std::vector<planet>& planets);  //  adds them at once, their accelerations are computed by finalize too
+    void load(const std::string path, const double mass = 0.);  //  idem for all the bodies of a file (binary, Horizons or CSV table, see loader.hpp); mass is the one of a Horizons body, in kg, which must be given
+    void finalize(const bool relativity = false);   //  computes the accelerations of every body and particle in one force pass; called by euler and verlet after add, add_many or load
+    void add_particle(planet body); //  test particle: attracted by the planets, attracts nothing, moved by euler and verlet only
+    void force(const force_method method, const double theta = 0.5);  //  direct sum by default
+    void threads(const int n);  //  number of threads used by euler and verlet, 1 by default
+    void format(const output_format format);    //  text by default
+    void energy(const energy_method method);    //  separate by default
+    void scheme(const integration_scheme scheme);   //  verlet2 by default
+    void steps(const int steps);    //  steps per year of verlet, 0 (default) for 365, or 9072000 in high-resolution
+    void asynchronous(const int capacity);  //  writes the files in a background thread, through a queue of capacity steps; 0 (default) to write them in the run
+    void checkpoint(const std::string path) const;  //  writes the whole state in a binary file, see checkpoint.hpp
+    void restore(const std::string path);   //  reads it back: the next runs give exactly the same values as the solver which wrote it
+    void checkpoints(const std::string path, const int steps);  //  euler and verlet write a checkpoint every steps steps, in a background thread; 0 (default) for none
+    void dense(const double interval);  //  euler and verlet write the positions every interval years, interpolated between the steps; 0 (default) to write them at the steps
+    void chebyshev(const double span, const int coefficients = 12);   //  euler and verlet fit the orbits with Chebyshev polynomials on spans of span years in folder + "ephemeris.bin", see ephemeris.hpp; 0 (default) for none
+    void perihelions(const std::string name);   //  euler and verlet write the perihelions of this body in "name perihelions", at any time-step, see solver-events.cpp
+    std::vector<std::vector<double>> acceleration(const bool relativity = false);  //  current accelerations with the chosen engine
     void print(std::ofstream& file) const;  //  prints the system's last position and velocity
     std::vector<double> mass_center(void) const;
     std::vector<planet> system(void) const;
+    std::vector<planet> particles(void) const;
 
     
 private:
 
+    //  one step of a run, copied for the output thread, see solver::asynchronous
+    struct frame
+    {
+        int step;
+        bool positions; //  writes the bodies
+        bool energies;  //  writes the energies
+        double time;    //  time of the positions
+        double clock;   //  time written before the energies, see solver::_update_quantities
+        double kinetic;
+        double potential;
+        double total;
+        bodies state;   //  masses, positions and velocities only
+    };
+
     //  data
     
     int _card;  //  number of planets in the system
     double _time;  //  t_0 of the system, in years
     double _total_mass;
+    force_method _method;
+    tree _tree;
+    int _threads;
+    output_format _format;
+    energy_method _energy;
+    integration_scheme _scheme;
+    int _steps; //  see solver::steps
+    long _evaluations;
+    bool _pending;  //  accelerations to compute before the next run, see solver::finalize
+    double _potential;  //  potential energy summed by the last force pass, if _potential_ready
+    bool _potential_ready;
+    std::vector<double> _thread_potential;  //  one per thread, see solver::_pairwise_acceleration
+    trajectory _output; //  data files of the current run
+    std::string _algorithm; //  first line of the text files of the current run
+    std::vector<double> _coordinates;   //  democratic heliocentric coordinates, see solver::wisdom_holman
+    std::vector<double> _stages;    //  derivatives of the stages, see solver-adaptive.cpp
+    std::vector<int> _rungs;    //  see solver::block_verlet
+    std::vector<double> _jerks; //  jerks at ti (x, y) then at ti+1, see solver::hermite
+    std::vector<int> _active;
+    int _capacity;  //  see solver::asynchronous
+    long _stalls;
+    std::unique_ptr<ring<frame>> _frames;    //  steps waiting for the output thread
+    std::thread _writer;
+    std::atomic<bool> _running;
+    std::vector<double> _buffer;    //  one part per thread, see solver::_pairwise_acceleration
+    std::string _checkpoint_path;   //  see solver::checkpoints
+    int _checkpoint_steps;
+    std::thread _checkpointer;
+    bodies _checkpoint_system;  //  copies of _system and _particles, written by _checkpointer
+    bodies _checkpoint_particles;
+    double _dense_interval; //  see solver::dense
+    int _dense_next;    //  next time of the grid, in intervals from the beginning of the run
+    int _dense_last;
+    bodies _dense;  //  positions and velocities interpolated at this time
+    bodies _step_start; //  positions and velocities at ti, see solver::_save_step
+    double _ephemeris_span; //  see solver::chebyshev
+    int _ephemeris_size;    //  coefficients per coordinate
+    int _ephemeris_records; //  spans in the current run
+    int _ephemeris_record;  //  span being sampled
+    int _ephemeris_node;    //  next node of this span
+    std::vector<double> _ephemeris_nodes;   //  times of the Chebyshev nodes from the beginning of a span, in increasing order
+    std::vector<double> _ephemeris_cosines; //  cos(pi i (j + 1/2) / n)
+    std::vector<double> _ephemeris_samples; //  x then y of each body at the nodes
+    std::vector<double> _ephemeris_coefficients;
+    std::vector<std::string> _perihelion_names; //  see solver::perihelions
+    std::vector<int> _perihelion_bodies;    //  their indices in the current run
+    std::vector<std::string> _perihelion_files;
+    int _perihelion_center; //  the perihelions are relative to the heaviest body
     std::vector<double> _mass_center;
-    std::vector<std::vector<double>> _prev_pos; //  contains all the position at ti
-    std::vector<std::vector<double>> _prev_vel;
-    std::vector<std::vector<double>> _prev_acc;
-    std::vector<std::vector<double>> _next_acc;
-    std::vector<planet> _system;    //  contains all the planet
+    bodies _system;    //  contains all the planets, and their quantities at ti
+    bodies _particles;  //  idem for the test particles, see solver::add_particle
     
     //  methods
     
     void _update_mass_center(const planet& body);
-    void _update_quantities(const int i, const double h);   //  update quantities at each lop
-    void _update_quantities(const int i, const double h, std::vector<std::vector<double>> acc);
-    std::vector<double> _acceleration(const int p, const bool relativity = false) const;    //  p is the index of the planet in _system
-    std::vector<std::vector<double>> _next_acceleration(const bool relativity) const;
-    
-    //  outputs
-    inline void _classic_output(const bool can_write, const int k, const int i, const std::string folder) const;
-    void _first_output(const int k, const int i, const double years, const std::string folder) const;
-    void _perihelion_output(const bool relativity, const bool highres, const int k, const int i, const double years, const std::string folder) const;
-    void _print_kinetic_energy(const int i, const std::string folder) const;
-    void _print_potential_energy(const int i, const std::string folder) const;
-    void _print_total_energy(const int i, const std::string folder) const;
+    void _add_table(bodies& table);    //  see solver::load
+    void _update_quantities(const double time);   //  update quantities at each lop, time of the new positions
+    void _euler_step(const double h);
+    void _euler_step(const double h, bodies& system);
+    void _verlet_positions(const double h);
+    void _verlet_positions(const double h, bodies& system);
+    void _verlet_velocities(const double h);
+    void _verlet_velocities(const double h, bodies& system);
+    void _verlet_step(const double h, const bool relativity);
+    void _drift(const double h);
+    void _drift(const double h, bodies& system);
+    void _kick(const double h, const bool relativity);
+    void _kick(const double h, bodies& system);
+    void _check_particles(const std::string algorithm) const;
+    int _central_body(void) const;
+    void _wisdom_holman_step(const int c, const double h);
+    void _interaction_kick(const int c, const double h);
+    void _jump(const int c, const double h);
+    void _hermite_step(const double h);
+    void _dormand_prince_stage(const int s, const double h);
+    void _block_step(const double h, const double eta);
+    void _acceleration(const int p, const bool relativity, double& ax, double& ay) const;    //  p is the index of the planet in _system
+    template <class law> void _acceleration(const int p, double& ax, double& ay) const;  //  idem with a force law, see solver-forces.cpp
+    void _next_acceleration(const bool relativity);    //  fills _system.next_ax and _system.next_ay
+    void _pairwise_acceleration(const bool relativity);    //  idem, see solver-forces.cpp
+    template <class law> void _pairwise_acceleration(void);
+    void _partial_acceleration(const std::vector<int>& active); //  idem for a few bodies
+    void _hermite_acceleration(void);   //  idem with the jerks at ti+1 in _jerks
+    void _particle_acceleration(void);  //  fills _particles.next_ax and _particles.next_ay
+    void _particle_acceleration(const int begin, const int end, double* ax, double* ay) const; //  the particles begin to end - 1 only
+    inline void _body_acceleration(const int k, const bool relativity, const double* x, const double* y, const double* m, double* ax, double* ay) const;
+    static int _thread_number(void);
+    
+    //  outputs, written in _output
+    void _open_output(const std::string folder, const std::string algorithm, const double years, const double h);
+    //  with an output thread, the positions and the energies are copied in a frame, see solver-output.cpp
+    void _output_positions(const int i, const double time, const bool verlet, const double years);
+    void _output_positions(const bodies& state, const int i, const double time, const bool verlet, const double years);
+    void _output_energies(void);
+    frame* _reserve_frame(void);
+    void _write_positions(const bodies& state, const int i, const double time, const bool verlet, const double years);
+    inline void _classic_output(const bodies& state, const int k, const int i);
+    void _first_output(const bodies& state, const int k, const int i, const double years);
+    void _perihelion_output(const bool relativity, const bool highres, const int k, const int i, const double years);   //  k is Mercury, see solver::verlet
+    void _print_energy(const std::string& name, const double time, const double energy);
+    void _start_writer(const bool verlet, const double years);
+    void _write_frames(const bool verlet, const double years);   //  body of the output thread
+    void _stop_writer(void);
+    void _drain_writer(void);
+    checkpoint_header _checkpoint_header(const double time) const;
+    void _periodic_checkpoint(const int i, const double time); //  time of the state after the step i
+    void _wait_checkpoint(void);
+    void _save_step(void);  //  before each step of euler and verlet, see solver-events.cpp
+    void _start_dense(const double years);
+    void _dense_output(const double start, const double ti, const double h, const double years);  //  the times of the grid between ti and ti + h, see solver-events.cpp
+    void _open_ephemeris(const std::string folder, const double start, const double years);
+    void _ephemeris_output(const double start, const double ti, const double h);  //  idem, for the nodes of the spans
+    void _open_perihelions(const double h);
+    void _detect_perihelions(const double start, const double h);  //  between start and start + h, see solver-events.cpp
     void _gnuplot(const std::string folder, const double years) const;
     void _gnuplot_png(const std::string folder, const double years) const;
     void _gnuplot_energies(const std::string folder, const double years) const;
@@ -87,76 +253,82 @@ private:
 };
 
 
-inline void solver::_classic_output(const bool can_write, const int k, const int i, const std::string folder) const
+//  acceleration of the body k with the engine of the solver, the tree must be built before
+inline void solver::_body_acceleration(const int k, const bool relativity, const double* x, const double* y, const double* m, double* ax, double* ay) const
 {
-    std::string path;
-    std::ofstream output;
-    
-    if(can_write && i != 0)
+    if(_system.center(k))
+    {
+        //  the mass center remains fixed, see solver::_acceleration
+        ax[k] = 0.;
+        ay[k] = 0.;
+    }
+    else if(_method == barnes_hut)
+    {
+        _tree.acceleration(k, ax[k], ay[k]);
+    }
+    else if(_method == simd)
+    {
+        kernel_acceleration(_card, x, y, m, ax, ay, k, k + 1);
+    }
+    else
     {
-        path = folder + _system[k].name();
-        output.open(path, std::ios::app);
-        _system[k].print_pos(output);
-        _system[k].print_vel(output);
-        output << std::endl;
-        output.close();
+        _acceleration(k, relativity, ax[k], ay[k]);
     }
 }
 
-inline void solver::_first_output(const int k, const int i, const double years, const std::string folder) const
+inline void solver::_classic_output(const bodies& state, const int k, const int i)
+{
+    if(i != 0)
+    {
+        std::ofstream& output = _output.body(k);
+        state.print_pos(k, output);
+        state.print_vel(k, output);
+        output << '\n';   //  std::endl would flush the buffer at each line
+    }
+}
+
+inline void solver::_first_output(const bodies& state, const int k, const int i, const double years)
 {
-    std::string path;
-    std::ofstream output;
-    
     if(i == 0)
     {
-        path = folder + _system[k].name();
-        output.open(path);  //  erase the previous file
-        output << "Velocity-Verlet algorithm (2D)" << std::endl;
-        output << _system[k].name() << " (x, y, vx, vy)" << std::endl;
-        output << "Timestep: " << years << " years" << std::endl << std::endl ;
-        if(_system[k].distance_center() == 0)
+        std::ofstream& output = _output.body(k);
+        output << "Velocity-Verlet algorithm (2D)" << '\n';
+        output << _system.name[k] << " (x, y, vx, vy)" << '\n';
+        output << "Timestep: " << years << " years" << '\n' << '\n' ;
+        if(state.center(k))
         {
             //  if the body is the mass center, its values never change
             //  so we print the initial values once, and never compute new ones
-            _system[k].print_pos(output);
-            _system[k].print_vel(output);
+            state.print_pos(k, output);
+            state.print_vel(k, output);
         }
-        output.close();
     }
 }
 
-inline void solver::_perihelion_output(const bool relativity, const bool highres, const int k, const int i, const double years, const std::string folder) const
+inline void solver::_perihelion_output(const bool relativity, const bool highres, const int k, const int i, const double years)
 {
-    std::string path;
-    std::ofstream output;
+    static const std::string perihelions = "mercury perihelion precession";
+    
+    if(i == 0)
+    {
+        std::ofstream& output = _output.file(perihelions);
+        output << "Perihelion precession of Mercury (xp, yp, thetap)" << '\n';
+        output << "Timestep: " << years << " earth-years" << '\n';
+        output << "Relativistic correction: " << std::boolalpha << relativity << '\n';
+        output << "High-resolution: " << std::boolalpha << highres << '\n' << '\n';
+        output << _time << "        ";
+        _system.print_pos(k, output);
+        output << "        " << atan(_system.y[k] / _system.x[k]);
+        output << '\n';
+    }
     
-    if((relativity || highres) && _system[k].name() == "mercury")
+    if(sqrt(_system.x[k] * _system.x[k] + _system.y[k] * _system.y[k]) <= 0.3075 && i != 0)
     {
-        if(i == 0)
-        {
-            path = folder + "mercury perihelion precession";
-            output.open(path);  //  erase the previous file
-            output << "Perihelion precession of Mercury (xp, yp, thetap)" << std::endl;
-            output << "Timestep: " << years << " earth-years" << std::endl;
-            output << "Relativistic correction: " << std::boolalpha << relativity << std::endl;
-            output << "High-resolution: " << std::boolalpha << highres << std::endl << std::endl;
-            output << _time << "        ";
-            _system[k].print_pos(output);
-            output << "        " << atan(_system[k].position[1] / _system[k].position[0]);
-            output << std::endl;
-            output.close();
-        }
-        
-        if(_system[k].distance_center() <= 0.3075 && i != 0)
-        {
-            path = folder + "mercury perihelion precession";
-            output.open(path, std::ios::app);  //  erase the previous file
-            output << _time << "        ";
-            _system[k].print_pos(output);
-            output << "        " << 648000 * atan(_system[k].position[1] / _system[k].position[0]);
-            output << std::endl;
-            output.close();
-        }
+        //  the file stays open, so we go back to the default precision for the time
+        std::ofstream& output = _output.file(perihelions);
+        output << std::setprecision(6) << _time << "        ";
+        _system.print_pos(k, output);
+        output << "        " << 648000 * atan(_system.y[k] / _system.x[k]);
+        output << '\n';
     }
 }
@@ -0,0 +1,240 @@
+//
+//  trajectory.cpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#include "trajectory.hpp"
+#include "bodies.hpp"
+#include "snapshots.hpp"
+#include "ephemeris.hpp"
+#include <vector>
+#include <string>
+#include <fstream>
+#include <mutex>
+#include <cstring>
+
+using namespace std;
+
+
+//  size of the buffer of each file
+static const int buffer_size = 1 << 16;
+
+
+//  constructors
+
+trajectory::trajectory(void)
+{
+}
+
+////////
+
+trajectory::~trajectory(void)
+{
+    close();
+}
+
+//  getters
+
+bool trajectory::is_open(void) const
+{
+    return (!_bodies.empty() || !_files.empty() || _binary || _ephemeris);
+}
+
+//  methods
+
+void trajectory::open(const std::string folder, const bodies& system)
+{
+    close();
+    _folder = folder;
+
+    for(int k = 0; k < system.size(); k++)
+    {
+        _bodies.push_back(_open(folder + system.name[k]));
+    }
+}
+
+////////
+
+void trajectory::open_binary(const std::string folder, const bodies& system, const std::string algorithm, const double years, const double h)
+{
+    int n = system.size();
+    snapshots_header header;
+    vector<char> names(n * snapshots_name_size, '\0');
+
+    close();
+    _folder = folder;
+    _binary = _open(folder + "trajectory.bin", true);
+    _frame.resize(1 + 4 * n);
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "NBODYTRJ", 8);
+    header.version = 1;
+    header.bodies = n;
+    header.step = h;
+    header.years = years;
+    strncpy(header.algorithm, algorithm.c_str(), sizeof(header.algorithm) - 1);
+    header.frame_offset = sizeof(header) + n * (snapshots_name_size + sizeof(double));
+    header.frame_size = _frame.size() * sizeof(double);
+
+    for(int k = 0; k < n; k++)
+    {
+        //  the names are cut at 31 characters
+        strncpy(names.data() + k * snapshots_name_size, system.name[k].c_str(), snapshots_name_size - 1);
+    }
+
+    _binary->file.write((const char*) &header, sizeof(header));
+    _binary->file.write(names.data(), names.size());
+    _binary->file.write((const char*) system.m.data(), n * sizeof(double));
+}
+
+////////
+
+void trajectory::snapshot(const double time, const bodies& system)
+{
+    int n = system.size();
+    double* frame = _frame.data();
+
+    frame[0] = time;
+
+    for(int k = 0; k < n; k++)
+    {
+        frame[1 + 4 * k] = system.x[k];
+        frame[2 + 4 * k] = system.y[k];
+        frame[3 + 4 * k] = system.vx[k];
+        frame[4 + 4 * k] = system.vy[k];
+    }
+
+    _binary->file.write((const char*) frame, _frame.size() * sizeof(double));
+}
+
+////////
+
+void trajectory::open_ephemeris(const std::string folder, const bodies& system, const double start, const double span, const int coefficients)
+{
+    int n = system.size();
+    ephemeris_header header;
+    vector<char> names(n * ephemeris_name_size, '\0');
+
+    _ephemeris = _open(folder + "ephemeris.bin", true);
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "NBODYEPH", 8);
+    header.version = 1;
+    header.bodies = n;
+    header.coefficients = coefficients;
+    header.start = start;
+    header.span = span;
+    header.record_offset = sizeof(header) + names.size();
+    header.record_size = 2 * n * coefficients * sizeof(double);
+
+    for(int k = 0; k < n; k++)
+    {
+        //  the names are cut at 31 characters
+        strncpy(names.data() + k * ephemeris_name_size, system.name[k].c_str(), ephemeris_name_size - 1);
+    }
+
+    _ephemeris->file.write((const char*) &header, sizeof(header));
+    _ephemeris->file.write(names.data(), names.size());
+}
+
+////////
+
+void trajectory::record(const std::vector<double>& coefficients)
+{
+    _ephemeris->file.write((const char*) coefficients.data(), coefficients.size() * sizeof(double));
+}
+
+////////
+
+std::ofstream& trajectory::body(const int k)
+{
+    return (_bodies[k]->file);
+}
+
+////////
+
+std::ofstream& trajectory::file(const std::string& name)
+{
+    lock_guard<mutex> lock(_files_mutex);
+    auto found = _files.find(name);
+
+    if(found == _files.end())
+    {
+        found = _files.emplace(name, _open(_folder + name)).first;
+    }
+
+    return (found->second->file);
+}
+
+////////
+
+void trajectory::flush(void)
+{
+    for(auto& output : _bodies)
+    {
+        output->file.flush();
+    }
+
+    for(auto& output : _files)
+    {
+        output.second->file.flush();
+    }
+
+    if(_binary)
+    {
+        _binary->file.flush();
+    }
+
+    if(_ephemeris)
+    {
+        _ephemeris->file.flush();
+    }
+}
+
+////////
+
+void trajectory::close(void)
+{
+    for(auto& output : _bodies)
+    {
+        output->file.close();
+    }
+
+    for(auto& output : _files)
+    {
+        output.second->file.close();
+    }
+
+    if(_binary)
+    {
+        _binary->file.close();
+    }
+
+    if(_ephemeris)
+    {
+        _ephemeris->file.close();
+    }
+
+    _bodies.clear();
+    _files.clear();
+    _binary.reset();
+    _ephemeris.reset();
+}
+
+////////
+
+std::unique_ptr<trajectory::stream> trajectory::_open(const std::string path, const bool binary)
+{
+    unique_ptr<stream> output(new stream);
+
+    //  the buffer must be given to the stream before the file is opened
+    output->buffer.resize(buffer_size);
+    output->file.rdbuf()->pubsetbuf(output->buffer.data(), buffer_size);
+    output->file.open(path, binary ? ios::out | ios::binary : ios::out);    //  erase the previous file
+
+    return (output);
+}
@@ -0,0 +1,75 @@
+//
+//  trajectory.hpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#pragma once
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+#include <fstream>
+#include <mutex>
+#include "bodies.hpp"
+
+
+//  all the data files written by the solver during one run of euler or verlet
+//  every file is opened once (and erased) at the beginning of the run, not at each time-step
+//  and written through a large buffer, so the run doesn't spend its time in system calls
+//  the files are complete after flush() or close()
+//  in the binary format, all the bodies go in a single file, see snapshots.hpp
+
+class trajectory
+{
+
+public:
+
+    //  constructors
+
+    trajectory(void);
+    ~trajectory(void);
+
+    //  getters
+
+    bool is_open(void) const;
+
+    //  methods
+
+    void open(const std::string folder, const bodies& system);  //  one file per body, named by the body
+    void open_binary(const std::string folder, const bodies& system, const std::string algorithm, const double years, const double h);   //  folder + "trajectory.bin"
+    void snapshot(const double time, const bodies& system); //  one frame of the binary file
+    void open_ephemeris(const std::string folder, const bodies& system, const double start, const double span, const int coefficients);   //  folder + "ephemeris.bin", after open or open_binary
+    void record(const std::vector<double>& coefficients);   //  one span of the ephemeris, see ephemeris.hpp
+    std::ofstream& body(const int k);   //  file of the body k
+    std::ofstream& file(const std::string& name);    //  any other file of the folder, opened the first time we ask for it, from any thread
+    void flush(void);   //  writes the buffers on the disk, the files remain open
+    void close(void);
+
+
+private:
+
+    //  a stream with its own buffer, which must not move as long as the file is open
+    struct stream
+    {
+        std::vector<char> buffer;
+        std::ofstream file;
+    };
+
+    //  data
+
+    std::string _folder;
+    std::vector<std::unique_ptr<stream>> _bodies;
+    std::map<std::string, std::unique_ptr<stream>> _files;
+    std::mutex _files_mutex;    //  the perihelions and the energies can be written by different threads
+    std::unique_ptr<stream> _binary;
+    std::unique_ptr<stream> _ephemeris;
+    std::vector<double> _frame;
+
+    //  methods
+
+    static std::unique_ptr<stream> _open(const std::string path, const bool binary = false);
+};
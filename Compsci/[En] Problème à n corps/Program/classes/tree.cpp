@@ -0,0 +1,254 @@
+//
+//  tree.cpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#include "tree.hpp"
+#include "bodies.hpp"
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+
+//  a cell with at most leaf_size bodies is not split
+//  the depth limit protects us against bodies sharing the same position
+static const int leaf_size = 8;
+static const int max_depth = 48;
+
+
+//  constructors
+
+tree::tree(void)
+{
+    _theta = 0.5;
+}
+
+////////
+
+tree::tree(const double theta)
+{
+    _theta = theta;
+}
+
+//  getters
+
+double tree::theta(void) const
+{
+    return (_theta);
+}
+
+////////
+
+int tree::size(void) const
+{
+    return ((int) _cells.size());
+}
+
+//  methods
+
+void tree::build(const bodies& system)
+{
+    int n = system.size();
+    double xmin, xmax, ymin, ymax;
+    cell root;
+
+    _cells.clear();
+    _index.resize(n);
+    _x.resize(n);
+    _y.resize(n);
+    _m.resize(n);
+
+    if(n == 0)
+    {
+        return;
+    }
+
+    xmin = xmax = system.x[0];
+    ymin = ymax = system.y[0];
+
+    for(int k = 0; k < n; k++)
+    {
+        _index[k] = k;
+        _x[k] = system.x[k];
+        _y[k] = system.y[k];
+        _m[k] = system.m[k];
+
+        xmin = min(xmin, _x[k]);
+        xmax = max(xmax, _x[k]);
+        ymin = min(ymin, _y[k]);
+        ymax = max(ymax, _y[k]);
+    }
+
+    //  the root is a square slightly bigger than the bounding box
+    root.x = 0.5 * (xmin + xmax);
+    root.y = 0.5 * (ymin + ymax);
+    root.half = 0.5 * max(xmax - xmin, ymax - ymin) * (1. + 1.E-9) + 1.E-12;
+    root.begin = 0;
+    root.end = n;
+
+    _cells.push_back(root);
+    _split(0, 0);
+}
+
+////////
+
+//  acceleration of the body p due to all the other bodies of the tree
+//  same sign convention and same arithmetic as solver::_acceleration
+void tree::acceleration(const int p, double& ax, double& ay) const
+{
+    double const g_const = 4 * M_PI * M_PI;
+    double theta_squared = _theta * _theta;
+    double px = _x[p];
+    double py = _y[p];
+    double dx, dy, r, r_squared, radical;
+    bool inside;
+    int stack[4 * max_depth + 8];
+    int top = 0;
+
+    ax = 0.;
+    ay = 0.;
+
+    if(_cells.empty())
+    {
+        return;
+    }
+
+    stack[top++] = 0;
+
+    while(top > 0)
+    {
+        const cell& current = _cells[stack[--top]];
+
+        dx = px - current.mx;
+        dy = py - current.my;
+        r_squared = dx * dx + dy * dy;
+
+        //  we never approximate a cell which contains the body itself
+        inside = fabs(px - current.x) <= current.half && fabs(py - current.y) <= current.half;
+
+        if(!inside && 4. * current.half * current.half < theta_squared * r_squared)
+        {
+            r = sqrt(r_squared);
+            radical = current.mass / (r_squared * r);
+            ax -= radical * dx;
+            ay -= radical * dy;
+        }
+        else if(current.child[0] == -1 && current.child[1] == -1 && current.child[2] == -1 && current.child[3] == -1)
+        {
+            for(int i = current.begin; i < current.end; i++)
+            {
+                int k = _index[i];
+
+                if(k != p)
+                {
+                    dx = px - _x[k];
+                    dy = py - _y[k];
+                    r = sqrt(dx * dx + dy * dy);
+                    radical = _m[k] / (r * r * r);
+                    ax -= radical * dx;
+                    ay -= radical * dy;
+                }
+            }
+        }
+        else
+        {
+            for(int q = 0; q < 4; q++)
+            {
+                if(current.child[q] != -1)
+                {
+                    stack[top++] = current.child[q];
+                }
+            }
+        }
+    }
+
+    ax *= g_const;
+    ay *= g_const;
+}
+
+////////
+
+//  recursively splits the cell c in four quadrants and computes its mass and center of mass
+//  careful: _cells grows during the recursion so we never keep a reference on a cell
+void tree::_split(const int c, const int depth)
+{
+    int begin = _cells[c].begin;
+    int end = _cells[c].end;
+    double x = _cells[c].x;
+    double y = _cells[c].y;
+    double half = _cells[c].half;
+    double mass = 0.;
+    double mx = 0.;
+    double my = 0.;
+    int bounds[5];
+
+    for(int q = 0; q < 4; q++)
+    {
+        _cells[c].child[q] = -1;
+    }
+
+    if(end - begin <= leaf_size || depth >= max_depth)
+    {
+        for(int i = begin; i < end; i++)
+        {
+            int k = _index[i];
+            mass += _m[k];
+            mx += _m[k] * _x[k];
+            my += _m[k] * _y[k];
+        }
+    }
+    else
+    {
+        //  quadrants 0 and 1 are below y, 0 and 2 are on the left of x
+        int* first = _index.data();
+        int middle = (int) (partition(first + begin, first + end, [&](int k) { return (_y[k] < y); }) - first);
+
+        bounds[0] = begin;
+        bounds[1] = (int) (partition(first + begin, first + middle, [&](int k) { return (_x[k] < x); }) - first);
+        bounds[2] = middle;
+        bounds[3] = (int) (partition(first + middle, first + end, [&](int k) { return (_x[k] < x); }) - first);
+        bounds[4] = end;
+
+        for(int q = 0; q < 4; q++)
+        {
+            if(bounds[q + 1] > bounds[q])
+            {
+                cell child;
+                int index = (int) _cells.size();
+
+                child.half = 0.5 * half;
+                child.x = (q % 2 == 0) ? x - child.half : x + child.half;
+                child.y = (q < 2) ? y - child.half : y + child.half;
+                child.begin = bounds[q];
+                child.end = bounds[q + 1];
+
+                _cells.push_back(child);
+                _cells[c].child[q] = index;
+                _split(index, depth + 1);
+
+                mass += _cells[index].mass;
+                mx += _cells[index].mass * _cells[index].mx;
+                my += _cells[index].mass * _cells[index].my;
+            }
+        }
+    }
+
+    _cells[c].mass = mass;
+
+    if(mass != 0.)
+    {
+        _cells[c].mx = mx / mass;
+        _cells[c].my = my / mass;
+    }
+    else
+    {
+        _cells[c].mx = x;
+        _cells[c].my = y;
+    }
+}
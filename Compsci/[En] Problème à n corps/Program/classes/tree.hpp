@@ -0,0 +1,70 @@
+//
+//  tree.hpp
+//  Program
+//
+//  Created by Antoine Hugounet on 18/10/2026.
+//  Copyright © 2017 Hugounet and Villeneuve. All rights reserved.
+//
+
+
+#pragma once
+#include <vector>
+#include "bodies.hpp"
+
+
+//  Barnes-Hut quadtree used by the solver to approximate the accelerations
+//  a cell of size s seen from a distance d is replaced by its total mass
+//  at its center of mass whenever s / d < theta
+//  theta = 0 opens every cell and gives back the direct sum
+
+class tree
+{
+
+public:
+
+    //  constructors
+
+    tree(void);
+    tree(const double theta);
+
+    //  getters
+
+    double theta(void) const;
+    int size(void) const;   //  number of cells
+
+    //  methods
+
+    void build(const bodies& system);
+    void acceleration(const int p, double& ax, double& ay) const;  //  p is the index of the body in the system given to build
+
+
+private:
+
+    //  a cell is a square of center (x, y) and half-side half
+    //  its bodies are _index[begin] to _index[end - 1]
+    struct cell
+    {
+        double x;
+        double y;
+        double half;
+        double mass;
+        double mx;  //  center of mass
+        double my;
+        int begin;
+        int end;
+        int child[4];   //  -1 if the quadrant is empty, all -1 for a leaf
+    };
+
+    //  data
+
+    double _theta;
+    std::vector<cell> _cells;   //  _cells[0] is the root
+    std::vector<int> _index;    //  bodies sorted by cell
+    std::vector<double> _x;
+    std::vector<double> _y;
+    std::vector<double> _m;
+
+    //  methods
+
+    void _split(const int c, const int depth);
+};
@@ -10,10 +10,92 @@
 #include "catch.hpp"
 #include "classes/planet.hpp"
 #include "classes/solver.hpp"
+#include "classes/basic-solver.hpp"
+#include "classes/kernels.hpp"
+#include "classes/snapshots.hpp"
+#include "classes/kepler.hpp"
+#include "classes/ensemble.hpp"
+#include "classes/ephemeris.hpp"
+#include "classes/loader.hpp"
 #include <cmath>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <iomanip>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <functional>
+#include <unistd.h>
+#include <sys/wait.h>
 
 using namespace std;
 
+
+//  counts every allocation of the program, see the test "Allocation-free steps"
+//  main.cpp runs these tests too, so the allocator is only replaced in a build of the tests with -DCOUNT_ALLOCATIONS
+//  (new[] and delete[] go through these ones)
+#ifdef COUNT_ALLOCATIONS
+
+static atomic<long> allocations(0);
+
+void* operator new(size_t size)
+{
+    void* memory = malloc((size > 0) ? size : 1);
+    
+    if(memory == nullptr)
+    {
+        throw bad_alloc();
+    }
+    
+    allocations.fetch_add(1, memory_order_relaxed);
+    
+    return (memory);
+}
+
+//  for the types aligned on more than 16 bytes, aligned_alloc needs a multiple of the alignment
+void* operator new(size_t size, align_val_t alignment)
+{
+    size_t bytes = (size_t) alignment;
+    void* memory = aligned_alloc(bytes, ((size > 0 ? size : 1) + bytes - 1) / bytes * bytes);
+    
+    if(memory == nullptr)
+    {
+        throw bad_alloc();
+    }
+    
+    allocations.fetch_add(1, memory_order_relaxed);
+    
+    return (memory);
+}
+
+//  not inlined, otherwise gcc sees free() called on the memory of operator new and warns
+__attribute__((noinline))
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+
+__attribute__((noinline))
+void operator delete(void* memory, size_t) noexcept
+{
+    free(memory);
+}
+
+__attribute__((noinline))
+void operator delete(void* memory, align_val_t) noexcept
+{
+    free(memory);
+}
+
+__attribute__((noinline))
+void operator delete(void* memory, size_t, align_val_t) noexcept
+{
+    free(memory);
+}
+
+#endif
+
 int run_unittest(int argc, const char* argv[])
 {
     
@@ -32,6 +114,16 @@ bool equality_big(const double x, const double y)
     return (abs(x - y) < 1.E6);;
 }
 
+std::string file_content(const std::string path)
+{
+    ifstream file(path);
+    stringstream content;
+    
+    content << file.rdbuf();
+    
+    return (content.str());
+}
+
 
 TEST_CASE("Several minor operations are tested for both planet and solver", "[planet and solver]")
 {
@@ -140,3 +232,1986 @@ TEST_CASE("Several minor operations are tested for both planet and solver", "[pl
         REQUIRE(system.mass_center() == position);
     }
 }
+
+
+TEST_CASE("Dimensions and scalar types of the planets", "[planet]")
+{
+    basic_planet<3> _comet("comet", 1.E20, {1., 2., 2.}, {0., 0., 1.E-2});
+    basic_planet<3> _flat_earth("earth", 6.E24, 8.30757514E-01, 5.54644964E-01, -9.79193739E-03, 1.42820162E-02);
+    planet _earth("earth", 6.E24, 8.30757514E-01, 5.54644964E-01, -9.79193739E-03, 1.42820162E-02);
+    
+    SECTION("3D")
+    {
+        REQUIRE(_comet.dim() == 3);
+        REQUIRE(_comet.distance_center() == 3.);
+        REQUIRE(_comet.velocity_squared() == 1.E-4);
+        
+        //  a planet given in the plane is at z = 0, with the same energies as in 2D
+        REQUIRE(_flat_earth.position[2] == 0.);
+        REQUIRE(_flat_earth.velocity[2] == 0.);
+        REQUIRE(_flat_earth.kinetic_energy() == _earth.kinetic_energy());
+        REQUIRE(equality_small(_comet.distance(_flat_earth), sqrt(pow(1. - 8.30757514E-01, 2) + pow(2. - 5.54644964E-01, 2) + 4.)));
+        
+        _comet.normalize();
+        REQUIRE(equality_small(_comet.velocity[2], 1.E-2 * 365.25));
+    }
+    
+    SECTION("float and long double")
+    {
+        basic_planet<2, float> light_earth("earth", 6.E24f, 8.30757514E-01f, 5.54644964E-01f, -9.79193739E-03f, 1.42820162E-02f);
+        basic_planet<3, long double> precise_comet("comet", 1.E20L, {1.L, 2.L, 2.L}, {0.L, 0.L, 1.E-2L});
+        
+        REQUIRE(light_earth.dim() == 2);
+        REQUIRE(abs(light_earth.distance_center() - _earth.distance_center()) < 1.E-6);
+        REQUIRE(precise_comet.distance_center() == 3.L);
+    }
+}
+
+TEST_CASE("Dimensions and scalar types of the solvers", "[solver][dimensions]")
+{
+    //  circular orbits around the fixed Sun, the Earth and Jupiter inclined by 30 and 10 degrees on different axes
+    double earth_speed = 2 * M_PI / 365.25;
+    double jupiter_speed = 2 * M_PI / sqrt(5.2) / 365.25;
+    double earth_tilt = M_PI / 6.;
+    double jupiter_tilt = M_PI / 18.;
+
+    planet _sun_masscenter("sun", 2.E30, 0., 0., 0., 0.);
+    planet _earth("earth", 6.E24, 1., 0., 0., earth_speed);
+    planet _jupiter("jupiter", 1.9E27, 0., 5.2, -jupiter_speed, 0.);
+    basic_planet<3> _sun_3d("sun", 2.E30, {0., 0., 0.}, {0., 0., 0.});
+    basic_planet<3> _earth_3d("earth", 6.E24, {1., 0., 0.}, {0., earth_speed * cos(earth_tilt), earth_speed * sin(earth_tilt)});
+    basic_planet<3> _jupiter_3d("jupiter", 1.9E27, {0., 5.2, 0.}, {-jupiter_speed * cos(jupiter_tilt), 0., jupiter_speed * sin(jupiter_tilt)});
+
+    string folder = "unit-tests-dimensions-";
+    vector<string> names = {"sun", "earth", "jupiter"};
+
+    SECTION("the steps of solver::verlet")
+    {
+        solver reference;
+        reference.add_many({_sun_masscenter, _earth, _jupiter});
+        reference.steps(100);
+        reference.verlet(1., folder);
+
+        basic_solver<2> plane;
+        basic_solver<3> space;
+
+        for(auto& body : {_sun_masscenter, _earth, _jupiter})
+        {
+            plane.add(body);
+            space.add(basic_planet<3>(body.name(), body.mass(), body.position[0], body.position[1], body.velocity[0], body.velocity[1]));
+        }
+
+        //  solver::verlet goes one step further than the given time
+        plane.verlet(1.01, folder, 100);
+        space.verlet(1.01, folder, 100);
+
+        for(int k = 0; k < 3; k++)
+        {
+            REQUIRE(plane.system()[k].position == reference.system()[k].position);
+            REQUIRE(plane.system()[k].velocity == reference.system()[k].velocity);
+            REQUIRE(space.system()[k].position[0] == reference.system()[k].position[0]);
+            REQUIRE(space.system()[k].position[1] == reference.system()[k].position[1]);
+            REQUIRE(space.system()[k].position[2] == 0.);
+        }
+
+        REQUIRE(plane.time() == 1.01);
+    }
+
+    SECTION("orbits out of the plane")
+    {
+        solver3d space;
+        space.add(_sun_3d);
+        space.add(_earth_3d);
+        space.add(_jupiter_3d);
+
+        double energy = space.total_energy();
+        array<double, 3> momentum = space.angular_momentum();
+
+        //  a quarter of the orbit of the Earth, at the top of its inclined circle
+        space.verlet(0.25, folder, 3650);
+        REQUIRE(abs(space.system()[1].position[2] - sin(earth_tilt)) < 1.E-4);
+        REQUIRE(abs(space.system()[1].position[0]) < 1.E-4);
+
+        space.verlet(10., folder);
+        REQUIRE(space.time() == 10.25);
+
+        //  the Sun is fixed but attracts along the radius, so the angular momentum is kept like the energy
+        REQUIRE(abs(space.total_energy() - energy) < 1.E-8 * abs(energy));
+
+        for(int i = 0; i < 3; i++)
+        {
+            REQUIRE(abs(space.angular_momentum()[i] - momentum[i]) < 1.E-13 * abs(momentum[2]));
+        }
+
+        //  each orbit stays in its plane, up to the attraction between the planets
+        array<double, 3> earth = space.system()[1].position;
+        array<double, 3> jupiter = space.system()[2].position;
+        REQUIRE(abs(earth[2] * cos(earth_tilt) - earth[1] * sin(earth_tilt)) < 2.E-4);
+        REQUIRE(abs(jupiter[2] * cos(jupiter_tilt) + jupiter[0] * sin(jupiter_tilt)) < 1.E-5);
+        REQUIRE(abs(jupiter[2]) > 0.5);
+    }
+
+    SECTION("the same orbit in any plane")
+    {
+        //  without Jupiter, the inclined orbit of the Earth is the flat one turned around the x axis
+        basic_solver<2> plane;
+        plane.add(_sun_masscenter);
+        plane.add(_earth);
+
+        solver3d space;
+        space.add(_sun_3d);
+        space.add(_earth_3d);
+
+        plane.verlet(3., folder);
+        space.verlet(3., folder);
+
+        array<double, 2> flat = plane.system()[1].position;
+        array<double, 3> tilted = space.system()[1].position;
+
+        REQUIRE(abs(tilted[0] - flat[0]) < 1.E-10);
+        REQUIRE(abs(tilted[1] - flat[1] * cos(earth_tilt)) < 1.E-10);
+        REQUIRE(abs(tilted[2] - flat[1] * sin(earth_tilt)) < 1.E-10);
+    }
+
+    SECTION("float and long double")
+    {
+        basic_solver<2, float> light;
+        basic_solver<2> usual;
+        basic_solver<3, long double> precise;
+        solver3d space;
+        long double pi = acos(-1.L);
+
+        light.add(basic_planet<2, float>("sun", 2.E30f, 0.f, 0.f, 0.f, 0.f));
+        light.add(basic_planet<2, float>("earth", 6.E24f, 1.f, 0.f, 0.f, (float) earth_speed));
+        usual.add(_sun_masscenter);
+        usual.add(_earth);
+        precise.add(basic_planet<3, long double>("sun", 2.E30L, {0.L, 0.L, 0.L}, {0.L, 0.L, 0.L}));
+        precise.add(basic_planet<3, long double>("earth", 6.E24L, {1.L, 0.L, 0.L}, {0.L, 2 * pi / 365.25L * cos(pi / 6.L), 2 * pi / 365.25L * sin(pi / 6.L)}));
+        space.add(_sun_3d);
+        space.add(_earth_3d);
+
+        light.verlet(1.f, folder);
+        usual.verlet(1., folder);
+        precise.verlet(1.L, folder);
+        space.verlet(1., folder);
+
+        for(int i = 0; i < 2; i++)
+        {
+            REQUIRE(abs(light.system()[1].position[i] - usual.system()[1].position[i]) < 1.E-4);
+        }
+        for(int i = 0; i < 3; i++)
+        {
+            REQUIRE(abs(precise.system()[1].position[i] - space.system()[1].position[i]) < 1.E-12);
+        }
+        REQUIRE(abs(precise.total_energy() - space.total_energy()) < 1.E-12);
+    }
+
+    for(auto& name : names)
+    {
+        remove((folder + name).c_str());
+    }
+    for(auto& name : {"system-kinetic-energy", "system-potential-energy", "system-total-energy"})
+    {
+        remove((folder + name).c_str());
+    }
+}
+
+TEST_CASE("Barnes-Hut accelerations against the direct sum", "[solver][tree]")
+{
+    //  a flat cluster of equal masses, no body dominates the others
+    //  so that the error really comes from the approximated cells
+    
+    solver cluster;
+    int n = 500;
+    unsigned long seed = 42;
+    vector<vector<double>> exact;
+    
+    for(int k = 0; k < n; k++)
+    {
+        double r, theta;
+        
+        //  a small linear congruential generator, we want the same cluster on every machine
+        seed = (1103515245 * seed + 12345) % 2147483648;
+        r = 5. * sqrt((double) seed / 2147483648.);
+        seed = (1103515245 * seed + 12345) % 2147483648;
+        theta = 2 * M_PI * (double) seed / 2147483648.;
+        
+        cluster.add(planet("body " + to_string(k), 1.E27, r * cos(theta) + 0.1, r * sin(theta) + 0.1, 0., 0.));
+    }
+    
+    exact = cluster.acceleration();
+    
+    //  root mean square error relatively to the root mean square acceleration
+    //  a body close to the center of the cluster has a nearly vanishing acceleration
+    //  so we don't look at the relative error body by body
+    auto error = [&](const double theta)
+    {
+        vector<vector<double>> approximated;
+        double sum = 0.;
+        double norm = 0.;
+        
+        cluster.force(solver::barnes_hut, theta);
+        approximated = cluster.acceleration();
+        
+        for(int k = 0; k < n; k++)
+        {
+            double dx = approximated[k][0] - exact[k][0];
+            double dy = approximated[k][1] - exact[k][1];
+            
+            sum += dx*dx + dy*dy;
+            norm += exact[k][0]*exact[k][0] + exact[k][1]*exact[k][1];
+        }
+        
+        return (sqrt(sum / norm));
+    };
+    
+    double error_0 = error(0.);
+    double error_3 = error(0.3);
+    double error_5 = error(0.5);
+    double error_8 = error(0.8);
+    
+    SECTION("theta = 0 opens every cell")
+    {
+        REQUIRE(error_0 < 1.E-12);
+    }
+    
+    SECTION("the error grows with theta and stays small")
+    {
+        REQUIRE(error_3 < error_5);
+        REQUIRE(error_5 < error_8);
+        REQUIRE(error_3 < 2.E-4);
+        REQUIRE(error_5 < 1.E-3);
+        REQUIRE(error_8 < 5.E-3);
+    }
+    
+    SECTION("back to the direct sum")
+    {
+        cluster.force(solver::direct);
+        REQUIRE(cluster.acceleration() == exact);
+    }
+}
+
+
+TEST_CASE("Pairwise accelerations against the direct sum", "[solver]")
+{
+    planet _earth("earth", 6.E24, 8.30757514E-01, 5.54644964E-01, -9.79193739E-03, 1.42820162E-02);
+    planet _jupiter("jupiter", 1.9E27, -4.54463137, -2.98088727, 4.05019642E-03, -5.95135698E-03);
+    planet _mars("mars", 6.6E23, -1.60063680E+00, 4.51266379E-01, -3.22884752E-03, -1.22815747E-02);
+    planet _sun("sun", 2.E30, 2.17112305E-03, 5.78452455E-03, -5.30635989E-06, 5.44444408E-06);
+    planet _mercury("mercury", 3.3E23, 0.3075, 0., 0., (12.44 / 365.25));
+    planet _sun_masscenter("sun", 2.E30, 0., 0., 0., 0.);
+    
+    solver system;
+    vector<vector<double>> exact;
+    vector<vector<double>> symmetric;
+    
+    SECTION("Newtonian")
+    {
+        system.add(_sun);
+        system.add(_earth);
+        system.add(_jupiter);
+        system.add(_mars);
+        
+        exact = system.acceleration();
+        system.force(solver::pairwise);
+        symmetric = system.acceleration();
+        
+        for(int k = 0; k < system.size(); k++)
+        {
+            REQUIRE(abs(symmetric[k][0] - exact[k][0]) < 1.E-12 * abs(exact[k][0]));
+            REQUIRE(abs(symmetric[k][1] - exact[k][1]) < 1.E-12 * abs(exact[k][1]));
+        }
+    }
+    
+    SECTION("Mercury-Sun with the relativistic correction and a fixed mass center")
+    {
+        system.add(_mercury, true);
+        system.add(_sun_masscenter, true);
+        
+        exact = system.acceleration(true);
+        system.force(solver::pairwise);
+        symmetric = system.acceleration(true);
+        
+        REQUIRE(symmetric == exact);
+        REQUIRE(symmetric[1][0] == 0.);
+        REQUIRE(symmetric[1][1] == 0.);
+    }
+}
+
+
+TEST_CASE("Vectorized accelerations against the direct sum", "[solver][kernels]")
+{
+    //  one more body than a multiple of 8 so that the scalar tail is used too
+    
+    solver cluster;
+    int n = 203;
+    unsigned long seed = 7;
+    vector<vector<double>> exact;
+    vector<double> x(n), y(n), m(n), ax(n), ay(n);
+    
+    for(int k = 0; k < n; k++)
+    {
+        seed = (1103515245 * seed + 12345) % 2147483648;
+        x[k] = 10. * (double) seed / 2147483648. - 5.;
+        seed = (1103515245 * seed + 12345) % 2147483648;
+        y[k] = 10. * (double) seed / 2147483648. - 5.;
+        seed = (1103515245 * seed + 12345) % 2147483648;
+        m[k] = 1.E24 + 1.E27 * (double) seed / 2147483648.;
+        
+        cluster.add(planet("body " + to_string(k), m[k], x[k], y[k], 0., 0.));
+        m[k] /= 2.E30;  //  see planet::normalize
+    }
+    
+    exact = cluster.acceleration();
+    
+    SECTION("every level supported by this processor")
+    {
+        for(int level = kernel_scalar; level <= kernel_best(); level++)
+        {
+            kernel_acceleration((kernel_level) level, n, x.data(), y.data(), m.data(), ax.data(), ay.data(), 0, n);
+            
+            for(int k = 0; k < n; k++)
+            {
+                REQUIRE(abs(ax[k] - exact[k][0]) < 1.E-12 * sqrt(exact[k][0]*exact[k][0] + exact[k][1]*exact[k][1]));
+                REQUIRE(abs(ay[k] - exact[k][1]) < 1.E-12 * sqrt(exact[k][0]*exact[k][0] + exact[k][1]*exact[k][1]));
+            }
+        }
+    }
+    
+    SECTION("the scalar level is the reference")
+    {
+        kernel_acceleration(kernel_scalar, n, x.data(), y.data(), m.data(), ax.data(), ay.data(), 0, n);
+        
+        for(int k = 0; k < n; k++)
+        {
+            REQUIRE(ax[k] == exact[k][0]);
+            REQUIRE(ay[k] == exact[k][1]);
+        }
+    }
+    
+    SECTION("through the solver")
+    {
+        vector<vector<double>> vectorized;
+        
+        cluster.force(solver::simd);
+        vectorized = cluster.acceleration();
+        
+        for(int k = 0; k < n; k++)
+        {
+            REQUIRE(abs(vectorized[k][0] - exact[k][0]) < 1.E-12 * sqrt(exact[k][0]*exact[k][0] + exact[k][1]*exact[k][1]));
+        }
+    }
+}
+
+
+TEST_CASE("Accelerations with several threads", "[solver][threads]")
+{
+    solver cluster;
+    int n = 301;
+    unsigned long seed = 3;
+    vector<vector<double>> serial;
+    vector<vector<double>> parallel;
+    
+    for(int k = 0; k < n; k++)
+    {
+        double x, y;
+        
+        seed = (1103515245 * seed + 12345) % 2147483648;
+        x = 10. * (double) seed / 2147483648. - 5.;
+        seed = (1103515245 * seed + 12345) % 2147483648;
+        y = 10. * (double) seed / 2147483648. - 5.;
+        
+        cluster.add(planet("body " + to_string(k), 1.E27, x, y, 0., 0.));
+    }
+    
+    SECTION("the engines which treat each body on its own don't depend on the number of threads")
+    {
+        for(auto method : {solver::direct, solver::simd, solver::barnes_hut})
+        {
+            cluster.force(method);
+            cluster.threads(1);
+            serial = cluster.acceleration();
+            cluster.threads(4);
+            parallel = cluster.acceleration();
+            
+            REQUIRE(parallel == serial);
+        }
+    }
+    
+    SECTION("pairwise: same number of threads, same results")
+    {
+        cluster.force(solver::pairwise);
+        serial = cluster.acceleration();
+        cluster.threads(3);
+        parallel = cluster.acceleration();
+        
+        REQUIRE(cluster.acceleration() == parallel);
+        
+        for(int k = 0; k < n; k++)
+        {
+            REQUIRE(abs(parallel[k][0] - serial[k][0]) < 1.E-10 * sqrt(serial[k][0]*serial[k][0] + serial[k][1]*serial[k][1]));
+            REQUIRE(abs(parallel[k][1] - serial[k][1]) < 1.E-10 * sqrt(serial[k][0]*serial[k][0] + serial[k][1]*serial[k][1]));
+        }
+    }
+}
+
+
+TEST_CASE("Binary trajectories", "[solver][snapshots]")
+{
+    //  the files are written in the current folder and removed at the end
+    
+    planet _earth("earth", 6.E24, 8.30757514E-01, 5.54644964E-01, -9.79193739E-03, 1.42820162E-02);
+    planet _jupiter("jupiter", 1.9E27, -4.54463137, -2.98088727, 4.05019642E-03, -5.95135698E-03);
+    planet _sun_masscenter("sun", 2.E30, 0., 0., 0., 0.);
+    
+    vector<string> names = {"earth", "jupiter", "sun", "system-kinetic-energy", "system-potential-energy", "system-total-energy", "trajectory.bin"};
+    string text_folder = "unit-tests-text-";
+    string binary_folder = "unit-tests-binary-";
+    
+    solver text_system;
+    text_system.add(_earth);
+    text_system.add(_jupiter);
+    text_system.add(_sun_masscenter);
+    
+    solver binary_system = text_system;
+    binary_system.format(solver::binary);
+    
+    SECTION("Verlet")
+    {
+        text_system.verlet(2., text_folder);
+        binary_system.verlet(2., binary_folder);
+        
+        snapshots trajectory(binary_folder + "trajectory.bin");
+        
+        REQUIRE(trajectory.bodies() == 3);
+        REQUIRE(trajectory.size() == 2 * 365 + 1);
+        REQUIRE(trajectory.name(1) == "jupiter");
+        REQUIRE(trajectory.mass(1) == 1.9E27 / 2.E30);
+        REQUIRE(trajectory.step() == 2. / (2 * 365));
+        
+        //  random access to the last frame, which is the state before the last step
+        REQUIRE(trajectory.time(2 * 365) == 2.);
+        
+        trajectory.text(binary_folder);
+        
+        for(int k = 0; k < 3; k++)
+        {
+            REQUIRE(file_content(binary_folder + names[k]) == file_content(text_folder + names[k]));
+        }
+    }
+    
+    SECTION("Euler")
+    {
+        text_system.euler(1., text_folder);
+        binary_system.euler(1., binary_folder);
+        
+        snapshots trajectory(binary_folder + "trajectory.bin");
+        trajectory.text(binary_folder);
+        
+        REQUIRE(trajectory.size() == 251);
+        
+        for(int k = 0; k < 3; k++)
+        {
+            REQUIRE(file_content(binary_folder + names[k]) == file_content(text_folder + names[k]));
+        }
+        
+        //  the energies are written in text files in both formats
+        REQUIRE(file_content(binary_folder + names[5]) == file_content(text_folder + names[5]));
+    }
+    
+    SECTION("Verlet with the dense output")
+    {
+        //  every body at every time, in the layout of Euler
+        text_system.dense(0.1);
+        binary_system.dense(0.1);
+        text_system.verlet(2., text_folder);
+        binary_system.verlet(2., binary_folder);
+        
+        snapshots trajectory(binary_folder + "trajectory.bin");
+        trajectory.text(binary_folder);
+        
+        REQUIRE(trajectory.size() == 21);
+        REQUIRE(trajectory.algorithm() == "Velocity-Verlet (2D), dense");
+        
+        for(int k = 0; k < 3; k++)
+        {
+            REQUIRE(file_content(binary_folder + names[k]) == file_content(text_folder + names[k]));
+        }
+    }
+    
+    for(auto& name : names)
+    {
+        remove((text_folder + name).c_str());
+        remove((binary_folder + name).c_str());
+    }
+}
+
+
+TEST_CASE("Buffered text files", "[solver][trajectory]")
+{
+    //  the files written through trajectory are compared to the ones written like before,
+    //  by opening each file in append mode and closing it at every line
+
+    planet _earth("earth", 6.E24, 8.30757514E-01, 5.54644964E-01, -9.79193739E-03, 1.42820162E-02);
+    planet _jupiter("jupiter", 1.9E27, -4.54463137, -2.98088727, 4.05019642E-03, -5.95135698E-03);
+    planet _sun_masscenter("sun", 2.E30, 0., 0., 0., 0.);
+
+    vector<string> names = {"earth", "jupiter", "sun"};
+    string buffered_folder = "unit-tests-buffered-";
+    string appended_folder = "unit-tests-appended-";
+
+    SECTION("flush and close")
+    {
+        bodies system;
+        trajectory output;
+        int steps = 3000;   //  more than the buffers of the files
+
+        system.push_back(_earth);
+        system.push_back(_jupiter);
+        system.push_back(_sun_masscenter);
+
+        output.open(buffered_folder, system);
+        REQUIRE(output.is_open());
+
+        for(int i = 0; i < steps; i++)
+        {
+            for(int k = 0; k < 3; k++)
+            {
+                ofstream appended;
+
+                if(i == 0)
+                {
+                    appended.open(appended_folder + names[k]);
+                    appended << names[k] << " (x, y, vx, vy)" << endl;
+                    output.body(k) << names[k] << " (x, y, vx, vy)" << '\n';
+                }
+                else
+                {
+                    appended.open(appended_folder + names[k], ios::app);
+                }
+
+                system.print_pos(k, appended);
+                system.print_vel(k, appended);
+                appended << endl;
+                appended.close();
+
+                system.print_pos(k, output.body(k));
+                system.print_vel(k, output.body(k));
+                output.body(k) << '\n';
+
+                system.x[k] += 1.E-3 * system.vx[k];
+                system.y[k] += 1.E-3 * system.vy[k];
+            }
+
+            output.file("notes") << i << '\n';
+
+            //  everything written so far is on the disk, and the files stay open
+            if(i == steps / 2)
+            {
+                output.flush();
+
+                for(int k = 0; k < 3; k++)
+                {
+                    REQUIRE(file_content(buffered_folder + names[k]) == file_content(appended_folder + names[k]));
+                }
+                REQUIRE(output.is_open());
+            }
+        }
+
+        output.close();
+        REQUIRE(!output.is_open());
+
+        for(int k = 0; k < 3; k++)
+        {
+            REQUIRE(file_content(buffered_folder + names[k]) == file_content(appended_folder + names[k]));
+        }
+
+        string notes = file_content(buffered_folder + "notes");
+        REQUIRE(count(notes.begin(), notes.end(), '\n') == steps);
+        REQUIRE(notes.substr(notes.size() - 5) == "2999\n");
+
+        remove((buffered_folder + "notes").c_str());
+    }
+
+    SECTION("copies of a solver")
+    {
+        //  an assigned solver writes the same files as the original one
+        solver original;
+        original.add(_earth);
+        original.add(_jupiter);
+        original.add(_sun_masscenter);
+
+        solver assigned;
+        assigned.add(_earth);
+        assigned = original;
+
+        REQUIRE(assigned.size() == 3);
+
+        original.verlet(1., appended_folder);
+        assigned.verlet(1., buffered_folder);
+
+        for(int k = 0; k < 3; k++)
+        {
+            REQUIRE(file_content(buffered_folder + names[k]) == file_content(appended_folder + names[k]));
+        }
+
+        for(auto& name : {"system-kinetic-energy", "system-potential-energy", "system-total-energy"})
+        {
+            REQUIRE(file_content(buffered_folder + name) == file_content(appended_folder + name));
+            remove((buffered_folder + name).c_str());
+            remove((appended_folder + name).c_str());
+        }
+    }
+
+    for(auto& name : names)
+    {
+        remove((buffered_folder + name).c_str());
+        remove((appended_folder + name).c_str());
+    }
+}
+
+
+TEST_CASE("Asynchronous output", "[solver]")
+{
+    //  the output thread must write exactly the same files as the run itself
+    
+    planet _earth("earth", 6.E24, 8.30757514E-01, 5.54644964E-01, -9.79193739E-03, 1.42820162E-02);
+    planet _jupiter("jupiter", 1.9E27, -4.54463137, -2.98088727, 4.05019642E-03, -5.95135698E-03);
+    planet _sun_masscenter("sun", 2.E30, 0., 0., 0., 0.);
+    
+    vector<string> names = {"earth", "jupiter", "sun", "system-kinetic-energy", "system-potential-energy", "system-total-energy", "trajectory.bin"};
+    string sync_folder = "unit-tests-sync-";
+    string async_folder = "unit-tests-async-";
+    
+    solver sync_system;
+    sync_system.add(_earth);
+    sync_system.add(_jupiter);
+    sync_system.add(_sun_masscenter);
+    
+    SECTION("small queue, text files")
+    {
+        solver async_system = sync_system;
+        async_system.asynchronous(2);   //  the run will wait for the output thread
+        
+        sync_system.verlet(2., sync_folder);
+        async_system.verlet(2., async_folder);
+        
+        for(int k = 0; k < 6; k++)
+        {
+            REQUIRE(file_content(async_folder + names[k]) == file_content(sync_folder + names[k]));
+        }
+        
+        REQUIRE(sync_system.stalls() == 0);
+        REQUIRE(async_system.system()[0].position == sync_system.system()[0].position);
+        
+        //  the queue is used again by the next run
+        sync_system.euler(1., sync_folder);
+        async_system.euler(1., async_folder);
+        
+        for(int k = 0; k < 6; k++)
+        {
+            REQUIRE(file_content(async_folder + names[k]) == file_content(sync_folder + names[k]));
+        }
+    }
+    
+    SECTION("large queue, binary file")
+    {
+        sync_system.format(solver::binary);
+        solver async_system = sync_system;
+        async_system.asynchronous(1024);
+        
+        sync_system.verlet(2., sync_folder);
+        async_system.verlet(2., async_folder);
+        
+        REQUIRE(file_content(async_folder + names[6]) == file_content(sync_folder + names[6]));
+        REQUIRE(file_content(async_folder + names[3]) == file_content(sync_folder + names[3]));
+    }
+    
+    for(auto& name : names)
+    {
+        remove((sync_folder + name).c_str());
+        remove((async_folder + name).c_str());
+    }
+}
+
+
+TEST_CASE("Fused energies", "[solver]")
+{
+    //  the energies summed during the force pass are the ones of potential_energy, up to the rounding errors
+    
+    planet _earth("earth", 6.E24, 8.30757514E-01, 5.54644964E-01, -9.79193739E-03, 1.42820162E-02);
+    planet _jupiter("jupiter", 1.9E27, -4.54463137, -2.98088727, 4.05019642E-03, -5.95135698E-03);
+    planet _mars("mars", 6.6E23, -1.60063680E+00, 4.51266379E-01, -3.22884752E-03, -1.22815747E-02);
+    planet _sun_masscenter("sun", 2.E30, 0., 0., 0., 0.);
+    
+    vector<string> names = {"earth", "jupiter", "mars", "sun", "system-kinetic-energy", "system-potential-energy", "system-total-energy"};
+    string separate_folder = "unit-tests-separate-";
+    string fused_folder = "unit-tests-fused-";
+    
+    solver separate_system;
+    separate_system.add(_earth);
+    separate_system.add(_jupiter);
+    separate_system.add(_mars);
+    separate_system.add(_sun_masscenter);
+    separate_system.force(solver::pairwise);
+    separate_system.threads(2);
+    
+    solver fused_system = separate_system;
+    fused_system.energy(solver::fused);
+    
+    separate_system.verlet(1., separate_folder);
+    fused_system.verlet(1., fused_folder);
+    
+    //  the trajectories are the same
+    for(int k = 0; k < 4; k++)
+    {
+        REQUIRE(file_content(fused_folder + names[k]) == file_content(separate_folder + names[k]));
+    }
+    
+    for(int k = 4; k < 7; k++)
+    {
+        ifstream separate_file(separate_folder + names[k]);
+        ifstream fused_file(fused_folder + names[k]);
+        double separate_time, separate_energy;
+        double fused_time, fused_energy;
+        int lines = 0;
+        
+        while(separate_file >> separate_time >> separate_energy)
+        {
+            REQUIRE(fused_file >> fused_time >> fused_energy);
+            REQUIRE(fused_time == separate_time);
+            REQUIRE(abs(fused_energy - separate_energy) <= 1.E-10 * abs(separate_energy));
+            lines++;
+        }
+        
+        REQUIRE(lines == 366);
+    }
+    
+    for(auto& name : names)
+    {
+        remove((separate_folder + name).c_str());
+        remove((fused_folder + name).c_str());
+    }
+}
+
+
+TEST_CASE("Kepler drift", "[kepler]")
+{
+    double const mu = 4 * M_PI * M_PI;
+    double x, y, vx, vy;
+    
+    SECTION("ellipse")
+    {
+        //  starts at the perihelion, at 1 AU, with 80% of the circular velocity
+        double a = 1. / (2. - 0.64);
+        double period = pow(a, 1.5);
+        
+        x = 1.; y = 0.; vx = 0.; vy = 0.8 * 2 * M_PI;
+        kepler_drift(mu, 0.5 * period, x, y, vx, vy);
+        
+        REQUIRE(abs(x - (1. - 2 * a)) < 1.E-12);
+        REQUIRE(abs(y) < 1.E-12);
+        
+        kepler_drift(mu, 0.5 * period, x, y, vx, vy);
+        
+        REQUIRE(abs(x - 1.) < 1.E-12);
+        REQUIRE(abs(y) < 1.E-12);
+        REQUIRE(abs(vx) < 1.E-11);
+        REQUIRE(abs(vy - 0.8 * 2 * M_PI) < 1.E-11);
+    }
+    
+    SECTION("hyperbola")
+    {
+        double energy = 0.5 * 36 * M_PI * M_PI - mu;
+        
+        x = 1.; y = 0.; vx = 0.; vy = 6 * M_PI;
+        kepler_drift(mu, 5., x, y, vx, vy);
+        
+        REQUIRE(abs(0.5 * (vx * vx + vy * vy) - mu / sqrt(x * x + y * y) - energy) < 1.E-10 * energy);
+        REQUIRE(abs(x * vy - y * vx - 6 * M_PI) < 1.E-10);
+    }
+}
+
+
+TEST_CASE("Wisdom-Holman", "[solver]")
+{
+    planet _earth("earth", 6.E24, 8.30757514E-01, 5.54644964E-01, -9.79193739E-03, 1.42820162E-02);
+    planet _jupiter("jupiter", 1.9E27, -4.54463137, -2.98088727, 4.05019642E-03, -5.95135698E-03);
+    planet _sun("sun", 2.E30, 2.17112305E-03, 5.78452455E-03, -5.30635989E-06, 5.44444408E-06);
+    planet _sun_masscenter("sun", 2.E30, 0., 0., 0., 0.);
+    
+    vector<string> names = {"earth", "jupiter", "sun", "system-kinetic-energy", "system-potential-energy", "system-total-energy"};
+    string folder = "unit-tests-wisdom-holman-";
+    solver system;
+    
+    system.add(_earth);
+    system.add(_jupiter);
+    
+    SECTION("moving sun")
+    {
+        system.add(_sun);
+    }
+    
+    SECTION("sun as mass center")
+    {
+        system.add(_sun_masscenter);
+    }
+    
+    //  second order: 7 times more steps, about 49 times more accurate
+    solver reference = system;
+    solver weekly = system;
+    solver daily = system;
+    
+    reference.wisdom_holman(10., folder, 5000);
+    weekly.wisdom_holman(10., folder, 52);
+    daily.wisdom_holman(10., folder, 365);
+    
+    double weekly_error = 0.;
+    double daily_error = 0.;
+    
+    for(int k = 0; k < 3; k++)
+    {
+        array<double, 2> exact = reference.system()[k].position;
+        array<double, 2> weekly_position = weekly.system()[k].position;
+        array<double, 2> daily_position = daily.system()[k].position;
+        
+        weekly_error = max(weekly_error, sqrt(pow(weekly_position[0] - exact[0], 2) + pow(weekly_position[1] - exact[1], 2)));
+        daily_error = max(daily_error, sqrt(pow(daily_position[0] - exact[0], 2) + pow(daily_position[1] - exact[1], 2)));
+    }
+    
+    REQUIRE(weekly_error < 1.E-4);
+    REQUIRE(daily_error < 2.E-6);
+    REQUIRE(weekly_error > 30 * daily_error);
+    REQUIRE(daily.time() == 10.);
+    REQUIRE(file_content(folder + "earth").substr(0, 28) == "Wisdom-Holman algorithm (2D)");
+    
+    for(auto& name : names)
+    {
+        remove((folder + name).c_str());
+    }
+}
+
+
+//  error on Mercury after a year of verlet around a fixed Sun, compared to the exact Kepler orbit
+double kepler_error(const solver::integration_scheme scheme, const int steps, long& evaluations)
+{
+    planet _mercury("mercury", 3.3E23, 0.3075, 0., 0., (12.44 / 365.25));
+    planet _sun_masscenter("sun", 2.E30, 0., 0., 0., 0.);
+    string folder = "unit-tests-scheme-";
+    double x = 0.3075, y = 0., vx = 0., vy = 12.44;
+    
+    solver system;
+    system.add(_sun_masscenter);
+    system.add(_mercury);
+    system.scheme(scheme);
+    system.steps(steps);
+    system.verlet(1., folder);
+    
+    //  verlet computes one more step than the number of steps, after the force pass of finalize
+    kepler_drift(4 * M_PI * M_PI, (steps + 1) / ((double) steps), x, y, vx, vy);
+    evaluations = system.evaluations();
+    
+    for(string name : {"mercury", "sun", "system-kinetic-energy", "system-potential-energy", "system-total-energy"})
+    {
+        remove((folder + name).c_str());
+    }
+    
+    return (sqrt(pow(system.system()[1].position[0] - x, 2) + pow(system.system()[1].position[1] - y, 2)));
+}
+
+
+TEST_CASE("Integration schemes", "[solver]")
+{
+    long evaluations;
+    long coarse_evaluations;
+    double coarse;
+    double fine;
+    
+    SECTION("velocity Verlet")
+    {
+        coarse = kepler_error(solver::verlet2, 400, coarse_evaluations);
+        fine = kepler_error(solver::verlet2, 800, evaluations);
+        
+        REQUIRE(coarse / fine > 3.5);
+        REQUIRE(coarse_evaluations == 401 + 1);
+    }
+    
+    SECTION("Yoshida, fourth order")
+    {
+        coarse = kepler_error(solver::yoshida4, 400, coarse_evaluations);
+        fine = kepler_error(solver::yoshida4, 800, evaluations);
+        
+        REQUIRE(coarse / fine > 14.);
+        REQUIRE(coarse_evaluations == 3 * 401 + 1);
+    }
+    
+    SECTION("Yoshida, sixth order")
+    {
+        coarse = kepler_error(solver::yoshida6, 400, coarse_evaluations);
+        fine = kepler_error(solver::yoshida6, 800, evaluations);
+        
+        REQUIRE(coarse / fine > 50.);
+        REQUIRE(fine < 1.E-8);
+        REQUIRE(coarse_evaluations == 7 * 401 + 1);
+    }
+    
+    SECTION("Forest-Ruth")
+    {
+        coarse = kepler_error(solver::forest_ruth, 400, coarse_evaluations);
+        fine = kepler_error(solver::forest_ruth, 800, evaluations);
+        
+        REQUIRE(coarse / fine > 14.);
+        REQUIRE(coarse_evaluations == 3 * 401 + 2);
+    }
+}
+
+
+//  not run by default: ./tests "[benchmark]"
+TEST_CASE("Force evaluations per accuracy", "[.][benchmark]")
+{
+    vector<solver::integration_scheme> schemes = {solver::verlet2, solver::yoshida4, solver::yoshida6, solver::forest_ruth};
+    vector<string> names = {"verlet2", "yoshida4", "yoshida6", "forest_ruth"};
+    vector<double> targets = {1.E-4, 1.E-6, 1.E-8};
+    
+    cout << "force evaluations needed for an error on Mercury after one year" << endl;
+    cout << setw(14) << "scheme";
+    
+    for(double target : targets)
+    {
+        cout << setw(14) << target;
+    }
+    
+    cout << endl;
+    
+    for(size_t s = 0; s < schemes.size(); s++)
+    {
+        cout << setw(14) << names[s];
+        
+        for(double target : targets)
+        {
+            long evaluations = 0;
+            double error = 1.;
+            
+            //  the number of steps is doubled until the error is small enough
+            for(int steps = 50; steps <= (1 << 21) && error > target; steps *= 2)
+            {
+                error = kepler_error(schemes[s], steps, evaluations);
+            }
+            
+            cout << setw(14) << ((error <= target) ? to_string(evaluations) : "-");
+        }
+        
+        cout << endl;
+    }
+}
+
+
+TEST_CASE("Dormand-Prince", "[solver]")
+{
+    //  a comet with an eccentricity of 0.9, starting at its perihelion at 0.1 AU around a fixed Sun
+    
+    double const mu = 4 * M_PI * M_PI;
+    double velocity = sqrt(mu * 1.9 / 0.1);
+    planet _comet("comet", 1.E20, 0.1, 0., 0., velocity / 365.25);
+    planet _sun_masscenter("sun", 2.E30, 0., 0., 0., 0.);
+    string folder = "unit-tests-dormand-prince-";
+    vector<double> errors;
+    
+    for(double tolerance : {1.E-8, 1.E-10})
+    {
+        double x = 0.1, y = 0., vx = 0., vy = velocity;
+        double shortest = 1.;
+        double longest = 0.;
+        
+        solver system;
+        system.add(_sun_masscenter);
+        system.add(_comet);
+        system.format(solver::binary);
+        system.dormand_prince(2., folder, tolerance);
+        
+        kepler_drift(mu, 2., x, y, vx, vy);
+        errors.push_back(sqrt(pow(system.system()[1].position[0] - x, 2) + pow(system.system()[1].position[1] - y, 2)));
+        
+        //  small steps at the perihelions, large ones at the aphelions
+        snapshots trajectory(folder + "trajectory.bin");
+        
+        for(int f = 1; f < trajectory.size() - 1; f++)
+        {
+            shortest = min(shortest, trajectory.time(f) - trajectory.time(f - 1));
+            longest = max(longest, trajectory.time(f) - trajectory.time(f - 1));
+        }
+        
+        REQUIRE(longest > 50 * shortest);
+        REQUIRE(trajectory.time(trajectory.size() - 1) == 2.);
+        REQUIRE(system.time() == 2.);
+    }
+    
+    REQUIRE(errors[1] < 1.E-6);
+    REQUIRE(errors[0] > 30 * errors[1]);
+    
+    for(string name : {"trajectory.bin", "system-kinetic-energy", "system-potential-energy", "system-total-energy"})
+    {
+        remove((folder + name).c_str());
+    }
+}
+
+
+TEST_CASE("Block time-steps", "[solver]")
+{
+    planet _earth("earth", 6.E24, 8.30757514E-01, 5.54644964E-01, -9.79193739E-03, 1.42820162E-02);
+    planet _jupiter("jupiter", 1.9E27, -4.54463137, -2.98088727, 4.05019642E-03, -5.95135698E-03);
+    planet _mercury("mercury", 3.3E23, -1.537256803720000E-01, -4.326509049973161E-01, 2.084982792680136E-02, -8.026395475494962E-03);
+    planet _neptune("neptune", 1.03E26, 2.862286355822386E+01, -8.791151564880529E+00, 9.010839253968958E-04, 3.019851091079401E-03);
+    planet _sun("sun", 2.E30, 2.17112305E-03, 5.78452455E-03, -5.30635989E-06, 5.44444408E-06);
+    
+    vector<string> names = {"sun", "mercury", "earth", "jupiter", "neptune", "system-kinetic-energy", "system-potential-energy", "system-total-energy"};
+    string folder = "unit-tests-block-";
+    solver system;
+    
+    system.add(_sun);
+    system.add(_mercury);
+    system.add(_earth);
+    system.add(_jupiter);
+    system.add(_neptune);
+    
+    solver reference = system;
+    solver coarse = system;
+    solver fine = system;
+    
+    reference.dormand_prince(2., folder, 1.E-12);
+    coarse.block_verlet(2., folder, 12, 0.01);
+    fine.block_verlet(2., folder, 12, 0.005);
+    
+    double coarse_error = 0.;
+    double fine_error = 0.;
+    
+    for(int k = 0; k < 5; k++)
+    {
+        array<double, 2> exact = reference.system()[k].position;
+        
+        coarse_error = max(coarse_error, sqrt(pow(coarse.system()[k].position[0] - exact[0], 2) + pow(coarse.system()[k].position[1] - exact[1], 2)));
+        fine_error = max(fine_error, sqrt(pow(fine.system()[k].position[0] - exact[0], 2) + pow(fine.system()[k].position[1] - exact[1], 2)));
+    }
+    
+    //  second order in eta
+    REQUIRE(coarse_error < 2.E-3);
+    REQUIRE(coarse_error > 3 * fine_error);
+    
+    //  Mercury has the smallest steps, Neptune the largest, and the Sun follows Mercury
+    vector<int> rungs = coarse.rungs();
+    
+    REQUIRE(rungs[1] > rungs[2]);
+    REQUIRE(rungs[2] > rungs[3]);
+    REQUIRE(rungs[3] > rungs[4]);
+    REQUIRE(rungs[4] == 0);
+    REQUIRE(rungs[0] == rungs[1]);
+    REQUIRE(coarse.time() == 2.);
+    
+    //  one force pass per tick of the smallest steps, on the bodies whose steps end there
+    REQUIRE(coarse.evaluations() > 24 * (1 << rungs[1]));
+    REQUIRE(fine.evaluations() > coarse.evaluations());
+    
+    for(auto& name : names)
+    {
+        remove((folder + name).c_str());
+    }
+}
+
+
+TEST_CASE("Hermite", "[solver]")
+{
+    planet _mercury("mercury", 3.3E23, 0.3075, 0., 0., (12.44 / 365.25));
+    planet _sun_masscenter("sun", 2.E30, 0., 0., 0., 0.);
+    string folder = "unit-tests-hermite-";
+    vector<string> names = {"mercury", "sun", "earth", "jupiter", "system-kinetic-energy", "system-potential-energy", "system-total-energy"};
+    
+    SECTION("fourth order, one force evaluation per step")
+    {
+        vector<double> errors;
+        long evaluations;
+        
+        for(int steps : {400, 800})
+        {
+            double x = 0.3075, y = 0., vx = 0., vy = 12.44;
+            
+            solver system;
+            system.add(_sun_masscenter);
+            system.add(_mercury);
+            system.hermite(1., folder, steps);
+            
+            kepler_drift(4 * M_PI * M_PI, 1., x, y, vx, vy);
+            errors.push_back(sqrt(pow(system.system()[1].position[0] - x, 2) + pow(system.system()[1].position[1] - y, 2)));
+            
+            REQUIRE(system.evaluations() == steps + 1);
+            REQUIRE(system.time() == 1.);
+        }
+        
+        REQUIRE(errors[0] / errors[1] > 10.);
+        REQUIRE(errors[1] < 1.E-5);
+        
+        //  Verlet with the same number of force evaluations
+        REQUIRE(kepler_error(solver::verlet2, 800, evaluations) > 100 * errors[1]);
+    }
+    
+    SECTION("same results with several threads")
+    {
+        planet _earth("earth", 6.E24, 8.30757514E-01, 5.54644964E-01, -9.79193739E-03, 1.42820162E-02);
+        planet _jupiter("jupiter", 1.9E27, -4.54463137, -2.98088727, 4.05019642E-03, -5.95135698E-03);
+        planet _sun("sun", 2.E30, 2.17112305E-03, 5.78452455E-03, -5.30635989E-06, 5.44444408E-06);
+        
+        solver serial;
+        serial.add(_sun);
+        serial.add(_earth);
+        serial.add(_jupiter);
+        
+        solver parallel = serial;
+        parallel.threads(3);
+        
+        serial.hermite(2., folder, 100);
+        parallel.hermite(2., folder, 100);
+        
+        for(int k = 0; k < 3; k++)
+        {
+            REQUIRE(abs(parallel.system()[k].position[0] - serial.system()[k].position[0]) < 1.E-12);
+            REQUIRE(abs(parallel.system()[k].position[1] - serial.system()[k].position[1]) < 1.E-12);
+        }
+    }
+    
+    for(auto& name : names)
+    {
+        remove((folder + name).c_str());
+    }
+}
+
+TEST_CASE("Test particles", "[solver]")
+{
+    planet _earth("earth", 6.E24, 8.30757514E-01, 5.54644964E-01, -9.79193739E-03, 1.42820162E-02);
+    planet _light_earth("earth", 1., 8.30757514E-01, 5.54644964E-01, -9.79193739E-03, 1.42820162E-02);
+    planet _jupiter("jupiter", 1.9E27, -4.54463137, -2.98088727, 4.05019642E-03, -5.95135698E-03);
+    planet _sun_masscenter("sun", 2.E30, 0., 0., 0., 0.);
+    string folder = "unit-tests-particles-";
+    vector<string> names = {"sun", "jupiter", "earth", "system-kinetic-energy", "system-potential-energy", "system-total-energy"};
+    
+    SECTION("a particle moves like a planet without mass, and the planets don't see it")
+    {
+        for(auto scheme : {solver::verlet2, solver::yoshida4, solver::forest_ruth})
+        {
+            solver planets;
+            planets.add(_sun_masscenter);
+            planets.add(_jupiter);
+            planets.scheme(scheme);
+            
+            solver particles = planets;
+            particles.add_particle(_earth);
+            
+            solver light = planets;
+            light.add(_light_earth);
+            
+            planets.verlet(2., folder);
+            particles.verlet(2., folder);
+            light.verlet(2., folder);
+            
+            REQUIRE(particles.size() == 2);
+            REQUIRE(particles.particles().size() == 1);
+            REQUIRE(particles.system()[1].position[0] == planets.system()[1].position[0]);
+            REQUIRE(particles.system()[1].position[1] == planets.system()[1].position[1]);
+            REQUIRE(particles.total_energy() == planets.total_energy());
+            
+            REQUIRE(abs(particles.particles()[0].position[0] - light.system()[2].position[0]) < 1.E-12);
+            REQUIRE(abs(particles.particles()[0].position[1] - light.system()[2].position[1]) < 1.E-12);
+            REQUIRE(abs(particles.particles()[0].velocity[0] - light.system()[2].velocity[0]) < 1.E-12);
+        }
+        
+        solver particles;
+        particles.add(_sun_masscenter);
+        particles.add_particle(_earth);
+        
+        solver light;
+        light.add(_sun_masscenter);
+        light.add(_light_earth);
+        
+        particles.euler(1., folder);
+        light.euler(1., folder);
+        
+        REQUIRE(abs(particles.particles()[0].position[0] - light.system()[1].position[0]) < 1.E-12);
+        REQUIRE(abs(particles.particles()[0].position[1] - light.system()[1].position[1]) < 1.E-12);
+    }
+    
+    SECTION("same results with several threads, over several batches")
+    {
+        solver serial;
+        serial.add(_sun_masscenter);
+        serial.add(_jupiter);
+        
+        for(int p = 0; p < 600; p++)
+        {
+            double angle = 2 * M_PI * p / 600.;
+            double r = 2. + p / 300.;
+            double v = 2 * M_PI / sqrt(r) / 365.25;
+            
+            serial.add_particle(planet("asteroid", 1.E15, r * cos(angle), r * sin(angle), -v * sin(angle), v * cos(angle)));
+        }
+        
+        solver parallel = serial;
+        parallel.threads(3);
+        
+        serial.verlet(1., folder);
+        parallel.verlet(1., folder);
+        
+        vector<planet> serial_particles = serial.particles();
+        vector<planet> parallel_particles = parallel.particles();
+        
+        REQUIRE(parallel_particles.size() == 600);
+        
+        for(int p = 0; p < 600; p++)
+        {
+            REQUIRE(parallel_particles[p].position[0] == serial_particles[p].position[0]);
+            REQUIRE(parallel_particles[p].position[1] == serial_particles[p].position[1]);
+            
+            //  circular orbits around the sun, slightly perturbed by Jupiter
+            double r = 2. + p / 300.;
+            double distance = sqrt(pow(serial_particles[p].position[0], 2) + pow(serial_particles[p].position[1], 2));
+            REQUIRE(abs(distance - r) < 0.1 * r);
+        }
+    }
+    
+    for(auto& name : names)
+    {
+        remove((folder + name).c_str());
+    }
+}
+
+#ifdef COUNT_ALLOCATIONS
+
+//  the allocations of a run (files, buffers) don't depend on its length
+//  so the 1000 more steps of the second run must not allocate anything
+long extra_allocations(const solver& system, const function<void(solver&, const int)>& run)
+{
+    long first, second;
+    solver copy = system;
+    
+    run(copy, 100);   //  one-time allocations of the program (OpenMP threads, static objects...)
+    
+    first = allocations.load();
+    run(copy, 1000);
+    first = allocations.load() - first;
+    
+    second = allocations.load();
+    run(copy, 2000);
+    second = allocations.load() - second;
+    
+    return (second - first);
+}
+
+TEST_CASE("Allocation-free steps", "[solver]")
+{
+    planet _earth("earth", 6.E24, 8.30757514E-01, 5.54644964E-01, -9.79193739E-03, 1.42820162E-02);
+    planet _jupiter("jupiter", 1.9E27, -4.54463137, -2.98088727, 4.05019642E-03, -5.95135698E-03);
+    planet _sun_masscenter("sun", 2.E30, 0., 0., 0., 0.);
+    string folder = "unit-tests-allocations-";
+    vector<string> names = {"sun", "earth", "jupiter", "system-kinetic-energy", "system-potential-energy", "system-total-energy", "trajectory.bin"};
+    auto verlet = [&](solver& copy, const int steps)
+    {
+        copy.steps(steps);
+        copy.verlet(1., folder);
+    };
+    
+    solver system;
+    system.add(_sun_masscenter);
+    system.add(_earth);
+    system.add(_jupiter);
+    
+    SECTION("verlet")
+    {
+        system.add_particle(_earth);
+        system.threads(2);
+        
+        for(auto method : {solver::direct, solver::pairwise, solver::simd, solver::barnes_hut})
+        {
+            system.force(method);
+            REQUIRE(extra_allocations(system, verlet) == 0);
+        }
+        
+        system.format(solver::binary);
+        system.asynchronous(16);
+        system.scheme(solver::yoshida4);
+        
+        REQUIRE(extra_allocations(system, verlet) == 0);
+    }
+    
+    SECTION("the other algorithms")
+    {
+        REQUIRE(extra_allocations(system, [&](solver& copy, const int steps) {copy.euler(steps / 250., folder);}) == 0);
+        REQUIRE(extra_allocations(system, [&](solver& copy, const int steps) {copy.wisdom_holman(1., folder, steps);}) == 0);
+        REQUIRE(extra_allocations(system, [&](solver& copy, const int steps) {copy.hermite(1., folder, steps);}) == 0);
+        REQUIRE(extra_allocations(system, [&](solver& copy, const int steps) {copy.block_verlet(steps / 100., folder, 100);}) == 0);
+    }
+    
+    for(auto& name : names)
+    {
+        remove((folder + name).c_str());
+    }
+}
+
+#endif
+
+TEST_CASE("Ensembles", "[ensemble]")
+{
+    planet _earth("earth", 6.E24, 1., 0., 0., 2 * M_PI / 365.25);
+    planet _sun_masscenter("sun", 2.E30, 0., 0., 0., 0.);
+    string folder = "unit-tests-ensemble-";
+    vector<double> velocities = {0.017, 0.02, 0.023, 0.025, 0.03};
+    int members = (int) velocities.size();
+    
+    ensemble escape(members);
+    escape.add(_sun_masscenter);
+    escape.add(_earth);
+    
+    for(int e = 0; e < members; e++)
+    {
+        escape.velocity(e, 1, 0., velocities[e]);
+    }
+    
+    SECTION("each member is a solver with its own initial velocity")
+    {
+        escape.verlet(1.01, folder, 100);
+        
+        for(int e = 0; e < members; e++)
+        {
+            solver system;
+            system.add(_sun_masscenter);
+            system.add(planet("earth", 6.E24, 1., 0., 0., velocities[e]));
+            system.steps(100);
+            system.verlet(1., folder);
+            
+            REQUIRE(escape.body(e, 1).position == system.system()[1].position);
+            REQUIRE(escape.body(e, 1).velocity == system.system()[1].velocity);
+            REQUIRE(escape.body(e, 0).position == system.system()[0].position);
+        }
+        
+        REQUIRE(escape.time() == 1.01);
+    }
+    
+    SECTION("escape velocity")
+    {
+        //  sqrt(2 G M) = 0.0243 AU/day at 1 AU from the Sun
+        escape.verlet(20., folder);
+        
+        for(int e = 0; e < members; e++)
+        {
+            REQUIRE((escape.max_distance(e, 1) > 20.) == (velocities[e] > 0.0243));
+            REQUIRE(abs(escape.energy_error(e)) < 1.E-3);
+            REQUIRE(escape.min_distance(e, 1) <= 1.);
+        }
+    }
+    
+    SECTION("force exponents")
+    {
+        ensemble powers(4);
+        powers.add(_sun_masscenter);
+        powers.add(_earth);
+        
+        ensemble newtonian(4);
+        newtonian.add(_sun_masscenter);
+        newtonian.add(_earth);
+        
+        powers.exponent(1, 3.5);
+        powers.exponent(2, 3.9);
+        powers.exponent(3, 5.);
+        
+        powers.verlet(2., folder, 1000);
+        newtonian.verlet(2., folder, 1000);
+        
+        //  the members with the Newtonian force don't depend on the others
+        REQUIRE(powers.body(0, 1).position == newtonian.body(0, 1).position);
+        REQUIRE(powers.body(0, 1).velocity == newtonian.body(0, 1).velocity);
+        
+        //  nor the other ones, whether they are computed in a vector of 4 members or alone
+        ensemble alone(1);
+        alone.add(_sun_masscenter);
+        alone.add(_earth);
+        alone.exponent(0, 3.9);
+        alone.verlet(2., folder, 1000);
+        
+        REQUIRE(powers.body(2, 1).position == alone.body(0, 1).position);
+        REQUIRE(powers.body(2, 1).velocity == alone.body(0, 1).velocity);
+        
+        //  the circular velocity at 1 AU is the same for all the exponents
+        //  the circular orbits are stable below 4, the Earth goes away with 5
+        for(int e = 0; e < 4; e++)
+        {
+            REQUIRE((abs(powers.max_distance(e, 1) - 1.) < 1.E-3) == (e < 3));
+            REQUIRE(abs(powers.energy_error(e)) < 1.E-4);
+        }
+    }
+    
+    for(int e = 0; e < members; e++)
+    {
+        remove((folder + "sun " + to_string(e)).c_str());
+        remove((folder + "earth " + to_string(e)).c_str());
+    }
+    for(auto& name : {"sun", "earth", "system-kinetic-energy", "system-potential-energy", "system-total-energy", "ensemble-diagnostics"})
+    {
+        remove((folder + name).c_str());
+    }
+}
+
+TEST_CASE("Checkpoints", "[solver][checkpoint]")
+{
+    planet _earth("earth", 6.E24, 8.30757514E-01, 5.54644964E-01, -9.79193739E-03, 1.42820162E-02);
+    planet _jupiter("jupiter", 1.9E27, -4.54463137, -2.98088727, 4.05019642E-03, -5.95135698E-03);
+    planet _sun("sun", 2.E30, 1.E-3, -2.E-3, 1.E-6, 3.E-6);
+    planet _asteroid("asteroid", 1.E15, 2.5, 0., 0., 1.1E-2);
+    string folder = "unit-tests-checkpoint-";
+    string path = folder + "state.bin";
+    
+    solver original;
+    original.add(_sun);
+    original.add(_jupiter);
+    original.add(_earth);
+    original.add_particle(_asteroid);
+    
+    //  the restored solver must go on exactly like the one which wrote the checkpoint
+    auto same = [](const solver& a, const solver& b)
+    {
+        REQUIRE(a.size() == b.size());
+        REQUIRE(a.time() == b.time());
+        REQUIRE(a.total_mass() == b.total_mass());
+        REQUIRE(a.mass_center() == b.mass_center());
+        REQUIRE(a.total_energy() == b.total_energy());
+        
+        for(int k = 0; k < a.size(); k++)
+        {
+            REQUIRE(a.system()[k].name() == b.system()[k].name());
+            REQUIRE(a.system()[k].position == b.system()[k].position);
+            REQUIRE(a.system()[k].velocity == b.system()[k].velocity);
+        }
+        
+        REQUIRE(a.particles()[0].position == b.particles()[0].position);
+        REQUIRE(a.particles()[0].velocity == b.particles()[0].velocity);
+    };
+    
+    SECTION("restart")
+    {
+        original.verlet(1., folder);
+        original.checkpoint(path);
+        
+        solver restored;
+        restored.restore(path);
+        same(original, restored);
+        
+        original.verlet(1., folder);
+        restored.verlet(1., folder);
+        same(original, restored);
+        
+        original.euler(1., folder);
+        restored.euler(1., folder);
+        same(original, restored);
+    }
+    
+    SECTION("periodic checkpoints")
+    {
+        //  366 steps: the last checkpoint is written after the last one
+        original.checkpoints(path, 183);
+        original.verlet(1., folder);
+        
+        solver restored;
+        restored.restore(path);
+        REQUIRE(restored.time() == original.time());
+        REQUIRE(abs(restored.time() - 366. / 365.) < 1.E-12);
+        
+        restored.verlet(1., folder);
+        original.checkpoints(path, 0);
+        original.verlet(1., folder);
+        REQUIRE(restored.system()[2].position == original.system()[2].position);
+        REQUIRE(restored.particles()[0].position == original.particles()[0].position);
+    }
+
+    SECTION("the files are written with each checkpoint")
+    {
+        //  a checkpoint which can't be written stops the program, like a crash after the first 100 steps
+        //  their lines must already be in the files, with or without the output thread
+        for(int capacity : {0, 64})
+        {
+            pid_t child = fork();
+            int status;
+
+            if(child == 0)
+            {
+                original.asynchronous(capacity);
+                original.checkpoints(folder + "no-such-folder/state.bin", 100);
+                original.verlet(1., folder);
+                _exit(0);
+            }
+
+            waitpid(child, &status, 0);
+            REQUIRE(WIFEXITED(status));
+            REQUIRE(WEXITSTATUS(status) == 1);
+
+            for(auto& name : {"earth", "system-total-energy"})
+            {
+                ifstream file(folder + name);
+                string line;
+                int lines = 0;
+
+                while(getline(file, line))
+                {
+                    lines++;
+                }
+
+                REQUIRE(lines >= 100);
+            }
+        }
+    }
+
+    remove(path.c_str());
+    for(auto& name : {"sun", "jupiter", "earth", "system-kinetic-energy", "system-potential-energy", "system-total-energy"})
+    {
+        remove((folder + name).c_str());
+    }
+}
+
+TEST_CASE("Perihelions", "[solver][events]")
+{
+    //  Mercury at its perihelion on the x axis, around a fixed Sun: the next ones are at the multiples of a^(3/2) years
+    double a = 0.3870983098;
+    double e = 0.2056317524;
+    double q = a * (1. - e);
+    double period = pow(a, 1.5);
+    planet _mercury("mercury", 3.3E23, q, 0., 0., 2 * M_PI * sqrt((1. + e) / q) / 365.25);
+    planet _sun_masscenter("sun", 2.E30, 0., 0., 0., 0.);
+    string folder = "unit-tests-perihelions-";
+    
+    //  the perihelions written by the last run: t, x, y, theta
+    auto read = [&folder]()
+    {
+        vector<vector<double>> perihelions;
+        ifstream file(folder + "mercury perihelions");
+        string line;
+        double t, x, y, theta;
+        
+        for(int n = 0; n < 3; n++)
+        {
+            getline(file, line);
+        }
+        while(file >> t >> x >> y >> theta)
+        {
+            perihelions.push_back({t, x, y, theta});
+        }
+        
+        return (perihelions);
+    };
+    
+    SECTION("between the time-steps")
+    {
+        //  the perihelion distance doesn't depend on the step, only the period and the precession of Verlet do (as h^2)
+        for(int steps : {365, 3650})
+        {
+            solver system;
+            system.add(_sun_masscenter);
+            system.add(_mercury);
+            system.perihelions("mercury");
+            system.steps(steps);
+            system.verlet(2., folder);
+            
+            vector<vector<double>> perihelions = read();
+            REQUIRE(perihelions.size() == 8);
+            
+            for(int n = 0; n < 8; n++)
+            {
+                double r = sqrt(perihelions[n][1] * perihelions[n][1] + perihelions[n][2] * perihelions[n][2]);
+                
+                REQUIRE(abs(r - q) < ((steps == 365) ? 2.E-6 : 1.E-9));
+                REQUIRE(abs(perihelions[n][0] - (n + 1) * period) < ((steps == 365) ? 5.E-3 : 5.E-5));
+            }
+        }
+    }
+    
+    SECTION("with the substeps of Yoshida")
+    {
+        solver system;
+        system.add(_sun_masscenter);
+        system.add(_mercury);
+        system.perihelions("mercury");
+        system.scheme(solver::yoshida4);
+        system.steps(3650);
+        system.verlet(2., folder);
+        
+        vector<vector<double>> perihelions = read();
+        REQUIRE(perihelions.size() == 8);
+        
+        for(int n = 0; n < 8; n++)
+        {
+            double r = sqrt(perihelions[n][1] * perihelions[n][1] + perihelions[n][2] * perihelions[n][2]);
+            
+            REQUIRE(abs(r - q) < 1.E-10);
+            REQUIRE(abs(perihelions[n][0] - (n + 1) * period) < 1.E-8);
+            REQUIRE(abs(perihelions[n][3]) < 0.1);
+        }
+    }
+    
+    SECTION("relativistic precession with ordinary time-steps")
+    {
+        vector<double> last;
+        
+        for(bool relativity : {false, true})
+        {
+            solver system;
+            system.add(_sun_masscenter, relativity);
+            system.add(_mercury, relativity);
+            system.perihelions("mercury");
+            system.steps(20000);
+            system.verlet(10., folder, relativity);
+            
+            vector<vector<double>> perihelions = read();
+            REQUIRE(perihelions.size() == 41);
+            last.push_back(perihelions.back()[3]);
+        }
+        
+        //  43 arcseconds per century, the precession of the Newtonian run is the error of Verlet
+        REQUIRE(abs(last[1] - last[0] - 43. * 41. * period / 100.) < 0.2);
+    }
+    
+    for(auto& name : {"sun", "mercury", "mercury perihelions", "mercury perihelion precession", "system-kinetic-energy", "system-potential-energy", "system-total-energy"})
+    {
+        remove((folder + name).c_str());
+    }
+}
+
+TEST_CASE("Dense output", "[solver][dense]")
+{
+    planet _earth("earth", 6.E24, 1., 0., 0., 2 * M_PI / 365.25);
+    planet _sun_masscenter("sun", 2.E30, 0., 0., 0., 0.);
+    string folder = "unit-tests-dense-";
+    
+    solver system;
+    system.add(_sun_masscenter);
+    system.add(_earth);
+    system.format(solver::binary);
+    
+    SECTION("between the steps, the interpolation adds nothing to the error of Verlet")
+    {
+        //  on a fiftieth of the orbit, Verlet with 365 steps per year is still 1.E-5 close to the exact orbit
+        solver fine = system;
+        fine.steps(36500);
+        fine.dense(0.0005);
+        fine.verlet(0.02, folder);
+        vector<array<double, 2>> reference;
+        {
+            snapshots frames(folder + "trajectory.bin");
+            for(int f = 0; f < frames.size(); f++)
+            {
+                reference.push_back({frames.body(f, 1)[0], frames.body(f, 1)[1]});
+            }
+        }
+        
+        system.steps(365);
+        system.dense(0.0005);
+        system.verlet(0.02, folder);
+        
+        snapshots frames(folder + "trajectory.bin");
+        REQUIRE(frames.size() == 41);
+        REQUIRE(reference.size() == 41);
+        
+        double worst = 0.;
+        for(int f = 0; f < frames.size(); f++)
+        {
+            REQUIRE(frames.time(f) == f * 0.0005);
+            worst = max(worst, hypot(frames.body(f, 1)[0] - reference[f][0], frames.body(f, 1)[1] - reference[f][1]));
+        }
+        
+        //  a linear interpolation would add (2 pi h)^2 / 8 = 4.E-5
+        REQUIRE(worst < 1.5E-5);
+    }
+    
+    SECTION("on the steps, the values of the steps")
+    {
+        solver steps = system;
+        steps.steps(1000);
+        steps.verlet(1., folder);
+        vector<double> reference;
+        {
+            snapshots frames(folder + "trajectory.bin");
+            for(int f = 0; f < frames.size(); f++)
+            {
+                reference.push_back(frames.body(f, 1)[0]);
+            }
+        }
+        
+        system.steps(1000);
+        system.dense(0.002);
+        system.verlet(1., folder);
+        
+        snapshots frames(folder + "trajectory.bin");
+        REQUIRE(frames.size() == 501);
+        
+        for(int f = 0; f < frames.size(); f++)
+        {
+            REQUIRE(abs(frames.body(f, 1)[0] - reference[2 * f]) < 1.E-13);
+        }
+    }
+
+    SECTION("with the substeps of Yoshida, from the beginning of the step")
+    {
+        //  a circular orbit, which begins at (1, 0)
+        system.steps(100);
+        system.scheme(solver::yoshida4);
+        solver steps = system;
+        steps.verlet(1., folder);
+        vector<array<double, 2>> reference;
+        {
+            snapshots frames(folder + "trajectory.bin");
+            for(int f = 0; f < frames.size(); f++)
+            {
+                reference.push_back({frames.body(f, 1)[0], frames.body(f, 1)[1]});
+            }
+        }
+
+        system.dense(0.05);
+        system.verlet(1., folder);
+
+        snapshots frames(folder + "trajectory.bin");
+        REQUIRE(frames.size() == 21);
+        REQUIRE(frames.body(0, 1)[0] == 1.);
+        REQUIRE(frames.body(0, 1)[1] == 0.);
+
+        for(int f = 0; f < frames.size(); f++)
+        {
+            REQUIRE(abs(frames.body(f, 1)[0] - reference[5 * f][0]) < 1.E-13);
+            REQUIRE(abs(frames.body(f, 1)[1] - reference[5 * f][1]) < 1.E-13);
+        }
+    }
+
+    remove((folder + "trajectory.bin").c_str());
+    for(auto& name : {"system-kinetic-energy", "system-potential-energy", "system-total-energy"})
+    {
+        remove((folder + name).c_str());
+    }
+}
+
+TEST_CASE("Chebyshev ephemeris", "[solver][ephemeris]")
+{
+    double a = 0.3870983098;
+    double e = 0.2056317524;
+    double q = a * (1. - e);
+    planet _mercury("mercury", 3.3E23, q, 0., 0., 2 * M_PI * sqrt((1. + e) / q) / 365.25);
+    planet _earth("earth", 6.E24, 1., 0., 0., 2 * M_PI / 365.25);
+    planet _sun_masscenter("sun", 2.E30, 0., 0., 0., 0.);
+    string folder = "unit-tests-ephemeris-";
+    
+    //  the substeps of Yoshida don't change the state at ti the samples begin from
+    for(solver::integration_scheme scheme : {solver::verlet2, solver::yoshida4})
+    {
+        solver system;
+        system.add(_sun_masscenter);
+        system.add(_mercury);
+        system.add(_earth);
+        system.format(solver::binary);
+        system.steps(3650);
+        system.scheme(scheme);
+        system.dense(0.001);
+        system.chebyshev(0.025, 12);
+        system.verlet(1., folder);
+        
+        //  the ephemeris agrees with the dense output at any time, not only at the nodes
+        snapshots frames(folder + "trajectory.bin");
+        ephemeris orbits(folder + "ephemeris.bin");
+        
+        REQUIRE(orbits.size() == 40);
+        REQUIRE(orbits.bodies() == 3);
+        REQUIRE(orbits.index("earth") == 2);
+        REQUIRE(orbits.start() == 0.);
+        REQUIRE(abs(orbits.end() - 1.) < 1.E-12);
+        
+        double position = 0.;
+        double velocity = 0.;
+        for(int f = 0; f < frames.size(); f++)
+        {
+            for(int k = 0; k < 3; k++)
+            {
+                array<double, 4> state = orbits.state(k, frames.time(f));
+                const double* values = frames.body(f, k);
+                
+                position = max(position, hypot(state[0] - values[0], state[1] - values[1]));
+                velocity = max(velocity, hypot(state[2] - values[2], state[3] - values[3]));
+            }
+        }
+        
+        //  Mercury goes through 12 AU/year at its perihelion: 1.E-4 in relative for the velocities
+        REQUIRE(position < 1.E-7);
+        REQUIRE(velocity < 1.E-3);
+    }
+    
+    remove((folder + "trajectory.bin").c_str());
+    remove((folder + "ephemeris.bin").c_str());
+    for(auto& name : {"system-kinetic-energy", "system-potential-energy", "system-total-energy"})
+    {
+        remove((folder + name).c_str());
+    }
+}
+
+TEST_CASE("Loading initial conditions", "[solver][loader]")
+{
+    planet _earth("earth", 6.E24, 8.30757514E-01, 5.54644964E-01, -9.79193739E-03, 1.42820162E-02);
+    planet _jupiter("jupiter", 1.9E27, -4.54463137, -2.98088727, 4.05019642E-03, -5.95135698E-03);
+    planet _sun("sun", 2.E30, 1.E-3, -2.E-3, 1.E-6, 3.E-6);
+    string folder = "unit-tests-loader-";
+    
+    solver added;
+    added.add(_sun);
+    added.add(_jupiter);
+    added.add(_earth);
+    vector<vector<double>> accelerations = added.acceleration();
+    
+    //  same bodies, same mass center, and the accelerations of all the bodies
+    //  (solver::add only computes the one of the new body)
+    auto same = [&](solver& loaded)
+    {
+        REQUIRE(loaded.size() == 3);
+        REQUIRE(abs(loaded.total_mass() - added.total_mass()) < 1.E-12 * added.total_mass());
+        REQUIRE(abs(loaded.mass_center()[0] - added.mass_center()[0]) < 1.E-15);
+        REQUIRE(abs(loaded.mass_center()[1] - added.mass_center()[1]) < 1.E-15);
+        
+        for(int k = 0; k < 3; k++)
+        {
+            REQUIRE(loaded.system()[k].name() == added.system()[k].name());
+            REQUIRE(loaded.system()[k].mass() == added.system()[k].mass());
+            REQUIRE(abs(loaded.system()[k].position[0] - added.system()[k].position[0]) < 1.E-15);
+            REQUIRE(abs(loaded.system()[k].velocity[1] - added.system()[k].velocity[1]) < 1.E-15);
+            REQUIRE(abs(loaded.acceleration()[k][1] - accelerations[k][1]) < 1.E-15);
+        }
+    };
+    
+    SECTION("CSV")
+    {
+        ofstream file(folder + "table.csv");
+        file << setprecision(17);
+        file << "name, mass, x, y, vx, vy" << '\n' << "# solar system" << '\n';
+        for(auto& body : {_sun, _jupiter, _earth})
+        {
+            file << body.name() << ", " << body.mass() << ", " << body.position[0] << ", " << body.position[1] << ", " << body.velocity[0] << ", " << body.velocity[1] << '\n';
+        }
+        file.close();
+        
+        solver loaded;
+        loaded.load(folder + "table.csv");
+        same(loaded);
+    }
+    
+    SECTION("binary table")
+    {
+        write_table(folder + "table.bin", {_sun, _jupiter, _earth});
+        
+        solver loaded;
+        loaded.load(folder + "table.bin");
+        same(loaded);
+    }
+    
+    SECTION("Horizons")
+    {
+        //  the text layout in AU-D, and the CSV layout in KM-S
+        ofstream file(folder + "sun.txt");
+        file << setprecision(17);
+        file << "Target body name: Sun (10)                        {source: DE441}" << '\n';
+        file << "Output units    : AU-D" << '\n';
+        file << "$$SOE" << '\n';
+        file << "2458849.500000000 = A.D. 2020-Jan-01 00:00:00.0000 TDB " << '\n';
+        file << " X =" << _sun.position[0] << " Y =" << _sun.position[1] << " Z = 1.E-05" << '\n';
+        file << " VX=" << _sun.velocity[0] << " VY=" << _sun.velocity[1] << " VZ= 1.E-08" << '\n';
+        file << "$$EOE" << '\n';
+        file.close();
+        
+        file.open(folder + "jupiter.txt");
+        file << setprecision(17);
+        file << "Target body name: Jupiter (599)                   {source: jup365_merged}" << '\n';
+        file << "Output units    : KM-S" << '\n';
+        file << "$$SOE" << '\n';
+        file << "2458849.500000000, A.D. 2020-Jan-01 00:00:00.0000, " << _jupiter.position[0] * 149597870.7 << ", " << _jupiter.position[1] * 149597870.7;
+        file << ", 0., " << _jupiter.velocity[0] * 149597870.7 / 86400. << ", " << _jupiter.velocity[1] * 149597870.7 / 86400. << ", 0.," << '\n';
+        file << "$$EOE" << '\n';
+        file.close();
+        
+        solver loaded;
+        loaded.load(folder + "sun.txt", 2.E30);
+        loaded.load(folder + "jupiter.txt", 1.9E27);
+        loaded.add(_earth);
+        same(loaded);
+        
+        remove((folder + "sun.txt").c_str());
+        remove((folder + "jupiter.txt").c_str());
+    }
+    
+    //  the bodies added before see the new ones, and the first step uses them
+    SECTION("accelerations of the bodies already there")
+    {
+        write_table(folder + "table.bin", {_jupiter, _earth});
+        write_table(folder + "all.bin", {_sun, _jupiter, _earth});
+        
+        solver loaded;
+        loaded.add(_sun);
+        loaded.load(folder + "table.bin");
+        
+        solver all;
+        all.load(folder + "all.bin");
+        
+        loaded.verlet(1., folder);
+        all.verlet(1., folder);
+        REQUIRE(abs(loaded.system()[2].position[0] - all.system()[2].position[0]) < 1.E-12);
+        REQUIRE(abs(loaded.system()[0].position[1] - all.system()[0].position[1]) < 1.E-15);
+        
+        remove((folder + "all.bin").c_str());
+    }
+    
+    remove((folder + "table.csv").c_str());
+    remove((folder + "table.bin").c_str());
+    for(auto& name : {"sun", "jupiter", "earth", "system-kinetic-energy", "system-potential-energy", "system-total-energy"})
+    {
+        remove((folder + name).c_str());
+    }
+}
+
+TEST_CASE("Adding many bodies", "[solver]")
+{
+    planet _earth("earth", 6.E24, 8.30757514E-01, 5.54644964E-01, -9.79193739E-03, 1.42820162E-02);
+    planet _jupiter("jupiter", 1.9E27, -4.54463137, -2.98088727, 4.05019642E-03, -5.95135698E-03);
+    planet _sun("sun", 2.E30, 1.E-3, -2.E-3, 1.E-6, 3.E-6);
+    planet _asteroid("asteroid", 1.E15, 2.5, 0., 0., 1.1E-2);
+    string folder = "unit-tests-many-";
+    
+    //  neither add nor add_many computes any force: verlet finalizes the bodies by itself
+    solver one_by_one;
+    one_by_one.add_particle(_asteroid);
+    one_by_one.add(_sun);
+    one_by_one.add(_jupiter);
+    one_by_one.add(_earth);
+    
+    solver many;
+    many.add_particle(_asteroid);
+    many.add_many({_sun, _jupiter, _earth});
+    
+    REQUIRE(many.size() == 3);
+    REQUIRE(many.system()[2].name() == "earth");
+    REQUIRE(abs(many.total_mass() - one_by_one.total_mass()) < 1.E-12 * many.total_mass());
+    REQUIRE(abs(many.mass_center()[0] - one_by_one.mass_center()[0]) < 1.E-15);
+    REQUIRE(one_by_one.evaluations() == 0);
+    
+    //  the accelerations of the first bodies see the next ones
+    many.finalize();
+    long evaluations = many.evaluations();
+    many.verlet(1., folder);
+    one_by_one.verlet(1., folder);
+    
+    REQUIRE(many.evaluations() - evaluations == 366);
+    REQUIRE(one_by_one.evaluations() == 367);
+    for(int k = 0; k < 3; k++)
+    {
+        REQUIRE(many.system()[k].position == one_by_one.system()[k].position);
+        REQUIRE(many.system()[k].velocity == one_by_one.system()[k].velocity);
+    }
+    REQUIRE(many.particles()[0].position == one_by_one.particles()[0].position);
+    
+    for(auto& name : {"sun", "jupiter", "earth", "system-kinetic-energy", "system-potential-energy", "system-total-energy"})
+    {
+        remove((folder + name).c_str());
+    }
+}